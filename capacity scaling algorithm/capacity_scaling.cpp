@@ -2,6 +2,8 @@
 #include <fstream>
 
 #include "flow.h"
+#include "graph_reader.h"
+#include "min_cost_flow.h"
 using namespace std;
 
 
@@ -10,9 +12,49 @@ int main(int argc, char* argv[])
 {   
     if (argc > 1) 
     {
+    MaxFlowEngine engine = MaxFlowEngine::capacity_scaling;
+    string modus;
+    for (int i = 2; i < argc; ++i) //"--engine push_relabel|parallel_push_relabel|capacity_scaling|dinic" und ein Modus
+    {
+        if (string(argv[i]) == "--engine" && i+1 < argc)
+        {
+            engine = parse_max_flow_engine(argv[++i]);
+        }
+        else
+        {
+            modus = argv[i];
+        }
+    }
+    if (modus == "mincost") //Kanten "tail head capacity cost", b-Werte müssen erfüllt werden
+    {
+        EdgeList edges = read_edge_list(argv[1], true, true);
+        Graph g(edges.num_nodes, Graph::directed);
+        vector<double> costs(edges.num_edges());
+        for (int i = 0; i < edges.num_edges(); ++i)
+        {
+            costs[g.add_edge(edges.tails[i], edges.heads[i], edges.weights[i])] = edges.costs[i];
+        }
+        for (Graph::NodeId v = 0; v < g.num_nodes(); ++v)
+        {
+            g.set_bvalue(v, edges.bvalues[v]);
+        }
+        MinCostFlow mcf(g, costs);
+        cout << mcf.solve() << endl;
+        for (Graph::NodeId v = 0; v < g.num_nodes(); ++v)
+        {
+            for (auto n : g.get_node(v).adjacent_nodes())
+            {
+                if (mcf.flow(n.edge_id()) != 0)
+                {
+                    cout << v << " " << n.id() << " " << mcf.flow(n.edge_id()) << endl;
+                }
+            }
+        }
+        return 0;
+    }
     Network n(argv[1]);
 
-    Flow * f = n.push_relabel(0,1);
+    Flow * f = n.max_flow(0,1,engine);
     f->print();
     delete f;
     }
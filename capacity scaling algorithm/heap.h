@@ -0,0 +1,164 @@
+// heap.h (d-ary Heap)
+#ifndef HEAP_H
+#define HEAP_H
+
+#include <algorithm>
+#include <vector>
+#include <stdexcept>
+#include <utility>
+
+// A heap that must know where its objects are (e.g. to decrease the key of a
+// given vertex) passes an index policy: the heap calls
+// policy.set_index(object, index) whenever it puts an object at a new index.
+// The policy is a template parameter, so the call is inlined; the default
+// policy does nothing.
+struct NoIndexPolicy
+{
+    template <typename T>
+    void set_index(const T &, int) {}
+};
+
+// Arity is the number of children per node. Larger arities give shallower
+// trees, so decrease_key and insert need fewer steps, and the children of a
+// node lie next to each other in memory (4 keyed items fill a cache line).
+template <typename T, int Arity = 2, typename IndexPolicy = NoIndexPolicy>  // assume that T has the < operator
+class Heap {
+    static_assert(Arity >= 2, "a heap node needs at least two children");
+public:
+    explicit Heap(IndexPolicy policy = IndexPolicy()): _policy(std::move(policy)) {}
+
+    bool is_empty() const
+    {
+        return _data.size() == 0;
+    }
+
+    const T & find_min() const
+    {
+        if (is_empty()) {
+            throw std::runtime_error("Empty heap; Heap::find_min failed.");
+        }
+        return _data[0];
+    }
+
+    T extract_min()
+    {
+        T result = find_min();
+        remove(0);
+        return result;
+    }
+
+    int insert(const T & object)         // returns the final index of object
+    {
+        _data.push_back(object);
+        return sift_up(_data.size() - 1);
+    }
+
+    void clear()
+    {
+        _data.clear();
+    }
+
+protected:                         // accessible only for derived classes
+    void remove(int index)
+    {
+        ensure_is_valid_index(index);
+        T last = std::move(_data.back());
+        _data.pop_back();
+        if (index == static_cast<int>(_data.size())) {
+            return;                        // the removed object was the last one
+        }
+        if (index > 0 and last < _data[parent(index)]) {
+            _data[index] = std::move(last);
+            sift_up(index);
+        }
+        else {
+            _data[index] = std::move(last);
+            sift_down(index);
+        }
+    }
+
+    void decrease_key(int index)
+    {
+        ensure_is_valid_index(index);
+        sift_up(index);
+    }
+
+    T & get_object(int index)
+    {
+        ensure_is_valid_index(index);
+        return _data[index];
+    }
+
+    IndexPolicy & policy()
+    {
+        return _policy;
+    }
+
+    const IndexPolicy & policy() const
+    {
+        return _policy;
+    }
+
+private:
+    void  ensure_is_valid_index(int index)
+    {
+        if (index >= static_cast<int>(_data.size()) or index < 0)
+            throw std::runtime_error("Index error in heap operation");
+    }
+
+    static int parent(int index)          // do not call with index==0!
+    {
+        return (index - 1) / Arity;
+    }
+
+    static int first_child(int index)     // children may not exist!
+    {
+        return Arity * index + 1;
+    }
+
+    void place(int index, T && object)
+    {
+        _data[index] = std::move(object);
+        _policy.set_index(_data[index], index);
+    }
+
+    // Both sift operations move the object out and shift the others into
+    // the hole, so each step writes one object instead of swapping two.
+    int sift_up(int index)
+    {
+        T object = std::move(_data[index]);
+        while ((index > 0) and (object < _data[parent(index)])) {
+            place(index, std::move(_data[parent(index)]));
+            index = parent(index);
+        }
+        place(index, std::move(object));
+        return index;
+    }
+
+    int sift_down(int index)
+    {
+        T object = std::move(_data[index]);
+        const int size = _data.size();
+        while (first_child(index) < size) {
+            int smallest = first_child(index);
+            const int end = std::min(first_child(index) + Arity, size);
+            for (int child = smallest + 1; child < end; ++child) {
+                if (_data[child] < _data[smallest]) {
+                    smallest = child;
+                }
+            }
+            if (not (_data[smallest] < object)) {
+                break;
+            }
+            place(index, std::move(_data[smallest]));
+            index = smallest;
+        }
+        place(index, std::move(object));
+        return index;
+    }
+
+    std::vector<T> _data;       // holds the objects in heap order
+    IndexPolicy _policy;
+};
+
+#endif // HEAP_H
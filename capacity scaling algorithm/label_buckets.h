@@ -0,0 +1,111 @@
+// label_buckets.h (Active Vertices Bucketed by Label)
+#ifndef LABEL_BUCKETS_H
+#define LABEL_BUCKETS_H
+
+#include <vector>
+#include <stdexcept>
+
+// Holds a set of vertices, each with a label in 0,...,max_label. Vertices with
+// the same label form an intrusive doubly linked list, so insert, remove and
+// contains take constant time. highest() returns a vertex with the largest
+// label; it only moves the tracked maximum downwards, which costs no more than
+// the label increases of the inserted vertices (amortized constant).
+class LabelBuckets {
+public:
+    using NodeId = int;
+
+    LabelBuckets(NodeId num_nodes, int max_label):
+        _first(max_label + 1, none), _next(num_nodes, none), _prev(num_nodes, none),
+        _label(num_nodes, none), _max_label(0), _size(0) {}
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    bool contains(NodeId v) const
+    {
+        return _label[v] != none;
+    }
+
+    int label(NodeId v) const      // the label v was inserted with
+    {
+        return _label[v];
+    }
+
+    NodeId first(int label) const  // some vertex with this label, or -1
+    {
+        return _first[label];
+    }
+
+    int max_label() const          // no vertex has a larger label
+    {
+        return _max_label;
+    }
+
+    void clear()
+    {
+        _first.assign(_first.size(), none);
+        _label.assign(_label.size(), none);
+        _max_label = 0;
+        _size = 0;
+    }
+
+    void insert(NodeId v, int label)
+    {
+        if (contains(v) or label < 0 or label >= static_cast<int>(_first.size())) {
+            throw std::runtime_error("LabelBuckets::insert failed.");
+        }
+        _label[v] = label;
+        _prev[v] = none;
+        _next[v] = _first[label];
+        if (_first[label] != none) {
+            _prev[_first[label]] = v;
+        }
+        _first[label] = v;
+        if (label > _max_label) {
+            _max_label = label;
+        }
+        ++_size;
+    }
+
+    void remove(NodeId v)
+    {
+        if (not contains(v)) {
+            return;
+        }
+        if (_prev[v] != none) {
+            _next[_prev[v]] = _next[v];
+        } else {
+            _first[_label[v]] = _next[v];
+        }
+        if (_next[v] != none) {
+            _prev[_next[v]] = _prev[v];
+        }
+        _label[v] = none;
+        --_size;
+    }
+
+    NodeId highest()
+    {
+        if (empty()) {
+            throw std::runtime_error("Empty buckets; LabelBuckets::highest failed.");
+        }
+        while (_first[_max_label] == none) {
+            --_max_label;
+        }
+        return _first[_max_label];
+    }
+
+private:
+    static constexpr int none = -1;
+
+    std::vector<NodeId> _first;    // per label
+    std::vector<NodeId> _next;     // per vertex
+    std::vector<NodeId> _prev;
+    std::vector<int> _label;       // none if the vertex is not in the set
+    int _max_label;                // no vertex has a larger label
+    int _size;
+};
+
+#endif // LABEL_BUCKETS_H
@@ -0,0 +1,172 @@
+// min_cost_flow.cpp (Implementation of Class MinCostFlow)
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "min_cost_flow.h"
+
+MinCostFlow::MinCostFlow(const Graph & g, const std::vector<double> & costs):
+  _graph(g), _residual(g), _cost(_residual.num_arcs(), 0), _excess(g.num_nodes(), 0),
+  _potential(g.num_nodes(), 0), _heap(g.num_nodes(), false),
+  _dist(g.num_nodes(), Graph::infinite_weight), _pred(g.num_nodes(), -1)
+{
+   if (g.dirtype != Graph::directed) {
+        throw std::runtime_error("MinCostFlow needs a directed graph.");
+   }
+   if (static_cast<int>(costs.size()) < g.num_edge_ids()) {
+        throw std::runtime_error("MinCostFlow: missing edge costs.");
+   }
+   double supply = 0;
+   for (NodeId v = 0; v < g.num_nodes(); ++v) {
+        _excess[v] = g.get_node(v).bvalue();
+        supply += std::max(0.0, _excess[v]);
+        for (auto n: g.get_node(v).adjacent_nodes()) {
+            ResidualNetwork::ArcId a = _residual.arc_of_edge(n.edge_id());
+            _cost[a] = costs[n.edge_id()];
+            _cost[_residual.reverse(a)] = -costs[n.edge_id()];
+        }
+   }
+   _tolerance = 1e-12 * std::max(1.0, supply);
+}
+
+bool MinCostFlow::enough(double value, double delta) const
+{
+   return delta > 0 ? value >= delta : value > _tolerance;
+}
+
+void MinCostFlow::saturate_negative_arcs(double delta)
+{
+   for (NodeId v = 0; v < _graph.num_nodes(); ++v) {
+        for (auto a = _residual.first_arc(v); a < _residual.first_arc(v + 1); ++a) {
+            NodeId w = _residual.head(a);
+            double rest = _residual.residual_capacity(a);
+            if (enough(rest, delta) and _cost[a] + _potential[v] - _potential[w] < 0) {
+                _residual.push(a, rest);
+                _excess[v] -= rest;
+                _excess[w] += rest;
+            }
+        }
+   }
+}
+
+bool MinCostFlow::augment(double delta)
+{
+   // sources whose excess dropped below delta are gone for this phase
+   _sources.erase(std::remove_if(_sources.begin(), _sources.end(),
+                                 [this, delta](NodeId v) { return not enough(_excess[v], delta); }),
+                  _sources.end());
+   for (NodeId v: _sources) {
+        _dist[v] = 0;
+        _touched.push_back(v);
+        _heap.insert(v, 0);
+   }
+   NodeId target = Graph::invalid_node;
+   while (not _heap.is_empty()) {
+        NodeId v = _heap.extract_min();
+        _settled.push_back(v);
+        if (enough(-_excess[v], delta)) {
+            target = v;
+            break;
+        }
+        for (auto a = _residual.first_arc(v); a < _residual.first_arc(v + 1); ++a) {
+            if (not enough(_residual.residual_capacity(a), delta)) {
+                continue;
+            }
+            NodeId w = _residual.head(a);
+            double dist = _dist[v] + _cost[a] + _potential[v] - _potential[w];
+            if (dist < _dist[w]) {
+                if (_dist[w] == Graph::infinite_weight) {
+                    _touched.push_back(w);
+                    _dist[w] = dist;
+                    _pred[w] = a;
+                    _heap.insert(w, dist);
+                } else if (_heap.is_member(w)) {
+                    _dist[w] = dist;
+                    _pred[w] = a;
+                    _heap.decrease_key(w, dist);
+                }
+            }
+        }
+   }
+   if (target != Graph::invalid_node) {
+        // keeps the reduced costs of all arcs with residual capacity >= delta
+        // nonnegative and makes them 0 along the shortest path
+        for (NodeId v: _settled) {
+            _potential[v] += _dist[v] - _dist[target];
+        }
+        double amount = -_excess[target];
+        NodeId source = target;
+        for (; _pred[source] != -1; source = _residual.head(_residual.reverse(_pred[source]))) {
+            amount = std::min(amount, _residual.residual_capacity(_pred[source]));
+        }
+        amount = std::min(amount, _excess[source]);
+        for (NodeId v = target; _pred[v] != -1; v = _residual.head(_residual.reverse(_pred[v]))) {
+            _residual.push(_pred[v], amount);
+        }
+        _excess[source] -= amount;
+        _excess[target] += amount;
+        ++_num_augmentations;
+   }
+   _heap.clear();
+   for (NodeId v: _touched) {
+        _dist[v] = Graph::infinite_weight;
+        _pred[v] = -1;
+   }
+   _touched.clear();
+   _settled.clear();
+   return target != Graph::invalid_node;
+}
+
+double MinCostFlow::solve()
+{
+   double max_value = 0;
+   for (auto a = 0; a < _residual.num_arcs(); ++a) {
+        max_value = std::max(max_value, _residual.capacity(a));
+   }
+   for (double excess: _excess) {
+        max_value = std::max(max_value, std::fabs(excess));
+   }
+   double delta = 0;
+   if (max_value >= 1) {
+        int exponent;
+        std::frexp(max_value, &exponent);     // max_value = m * 2^exponent with 0.5 <= m < 1
+        delta = std::ldexp(1.0, exponent - 1);
+   }
+   while (true) {
+        saturate_negative_arcs(delta);
+        _sources.clear();
+        for (NodeId v = 0; v < _graph.num_nodes(); ++v) {
+            if (enough(_excess[v], delta)) {
+                _sources.push_back(v);
+            }
+        }
+        while (augment(delta)) {}
+        if (delta == 0) {
+            break;
+        }
+        delta = delta > 1 ? delta / 2 : 0;
+   }
+   for (double excess: _excess) {
+        if (std::fabs(excess) > _tolerance) {
+            throw std::runtime_error("The b-values cannot be satisfied.");
+        }
+   }
+   return total_cost();
+}
+
+double MinCostFlow::flow(Graph::EdgeId e) const
+{
+   return _residual.flow(_residual.arc_of_edge(e));
+}
+
+double MinCostFlow::total_cost() const
+{
+   double cost = 0;
+   for (NodeId v = 0; v < _graph.num_nodes(); ++v) {
+        for (auto n: _graph.get_node(v).adjacent_nodes()) {
+            ResidualNetwork::ArcId a = _residual.arc_of_edge(n.edge_id());
+            cost += _residual.flow(a) * _cost[a];
+        }
+   }
+   return cost;
+}
@@ -0,0 +1,54 @@
+// min_cost_flow.h (Declaration of Class MinCostFlow)
+#ifndef MIN_COST_FLOW_H
+#define MIN_COST_FLOW_H
+
+#include <vector>
+#include "graph.h"
+#include "residual_network.h"
+#include "node_heap.h"
+
+// Min-cost b-flow by successive shortest paths with capacity scaling.
+// The edge weights of the directed graph are the capacities, the b-values
+// are supplies (b > 0) and demands (b < 0): every vertex v must send out
+// b(v) more than it receives. Costs may be negative.
+//
+// In the delta phase all arcs with residual capacity >= delta and negative
+// reduced cost are saturated first; afterwards paths from vertices with
+// excess >= delta to vertices with excess <= -delta are found by Dijkstra
+// with reduced costs on arcs with residual capacity >= delta. A final phase
+// with delta = 0 handles capacities and b-values that are not integral.
+class MinCostFlow {
+public:
+  using NodeId = Graph::NodeId;
+
+  // costs is indexed by Graph::EdgeId
+  MinCostFlow(const Graph & g, const std::vector<double> & costs);
+
+  // returns the total cost; throws if the b-values cannot be satisfied
+  double solve();
+
+  double flow(Graph::EdgeId e) const;
+  double total_cost() const;
+  int num_augmentations() const { return _num_augmentations; }
+
+private:
+  bool enough(double value, double delta) const;
+  void saturate_negative_arcs(double delta);
+  bool augment(double delta);
+
+  const Graph & _graph;
+  ResidualNetwork _residual;
+  std::vector<double> _cost;        // per arc; reverse arcs have the negated cost
+  std::vector<double> _excess;      // b-value minus net outflow
+  std::vector<double> _potential;
+  std::vector<NodeId> _sources;     // vertices with excess >= delta in this phase
+  NodeHeap<4> _heap;                // empty between runs
+  std::vector<double> _dist;        // Dijkstra labels, infinite_weight between runs
+  std::vector<ResidualNetwork::ArcId> _pred;
+  std::vector<NodeId> _touched;     // vertices with a finite label
+  std::vector<NodeId> _settled;
+  double _tolerance;                // smaller excesses count as rounding errors
+  int _num_augmentations = 0;
+};
+
+#endif // MIN_COST_FLOW_H
@@ -0,0 +1,241 @@
+// parallel_push_relabel.cpp (Phase 1 von Push-Relabel auf mehreren Threads)
+#include "flow.h"
+#include "parallel.h"
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+namespace {
+const int blockgroesse = 64; //so viele Knoten holt sich ein Thread auf einmal
+
+void atomar_addieren(std::atomic<double> & x, double delta)
+{
+    double alt = x.load(std::memory_order_relaxed);
+    while (!x.compare_exchange_weak(alt, alt+delta, std::memory_order_relaxed))
+    {
+    }
+}
+
+// ruft f(i) für alle i < anzahl auf, die Blöcke teilen sich die Threads über zaehler
+template <typename F>
+void bloecke_abarbeiten(std::atomic<size_t> & zaehler, size_t anzahl, F f)
+{
+    for (size_t beginn = zaehler.fetch_add(blockgroesse); beginn < anzahl; beginn = zaehler.fetch_add(blockgroesse))
+    {
+        for (size_t i = beginn; i < std::min(anzahl, beginn+blockgroesse); ++i)
+        {
+            f(i);
+        }
+    }
+}
+}
+
+// Synchrone Runden wie bei Baumstark, Blelloch und Shun: In einer Runde pusht jeder aktive
+// Knoten v nur über Bögen mit psi[v] == psi[w]+1 bezüglich der Labels vom Rundenbeginn. Über
+// ein Bogenpaar v,w pusht daher höchstens einer der beiden, und jeder Thread schreibt nur die
+// Bögen und den Überschuss der Knoten, die er entlädt; Zuflüsse sammeln sich atomar in
+// zufluss. Wer danach noch Überschuss hat, wird mit den unveränderten Labels relabelt, das
+// neue Label gilt ab der nächsten Runde. Dadurch bleibt psi gültig wie im sequentiellen Fall.
+void Network::parallele_phase_1(Flow * f, ResidualNetwork & residual,
+                                std::vector<double> & excess_values, int num_threads,
+                                double global_relabel_frequency){
+    int n = num_nodes();
+    NodeId s = f->source();
+    NodeId t = f->sink();
+    double toleranz = ueberschuss_toleranz(s, residual);
+    std::vector<int> psi(n, 0);
+    std::vector<int> neues_label(n, -1);
+    std::vector<std::atomic<double>> zufluss(n);
+    std::vector<std::atomic<char>> markiert(n); //Knoten steht in der Kandidatenliste eines Threads
+    std::vector<std::atomic<char>> besucht(n);  //für die Breitensuche
+    for (NodeId v = 0; v < n; ++v)
+    {
+        zufluss[v].store(0, std::memory_order_relaxed);
+        markiert[v].store(0, std::memory_order_relaxed);
+    }
+    auto ist_aktiv = [&](NodeId v)
+    {
+        return excess_values[v]>toleranz && v != t && v != s && psi[v] < n;
+    };
+    struct alignas(64) ThreadDaten
+    {
+        std::vector<NodeId> kandidaten;  //Überschuss oder Label haben sich geändert
+        std::vector<NodeId> zu_relabeln;
+        std::vector<NodeId> gefunden;    //nächste aktive Knoten bzw. nächste Ebene der Breitensuche
+        double arbeit = 0;
+    };
+    std::vector<ThreadDaten> daten(num_threads);
+    auto zusammenfassen = [&](std::vector<NodeId> & ziel) //nur Thread 0, zwischen zwei Barrieren
+    {
+        ziel.clear();
+        for (auto & d : daten)
+        {
+            ziel.insert(ziel.end(), d.gefunden.begin(), d.gefunden.end());
+            d.gefunden.clear();
+        }
+    };
+
+    std::vector<NodeId> aktiv;
+    std::vector<NodeId> ebene;
+    std::atomic<size_t> zaehler(0); //wird von Thread 0 vor jeder Barriere zurückgesetzt
+    bool neu_berechnen = true;
+    double arbeit = 0;
+    double arbeit_grenze = global_relabel_frequency * (6.0*n + residual.num_arcs());
+    Barrier barriere(num_threads);
+
+    auto labels_neu_berechnen = [&](int id) //wie labels_berechnen, Ebene für Ebene
+    {
+        ThreadDaten & meine = daten[id];
+        bloecke_abarbeiten(zaehler, n, [&](NodeId v)
+        {
+            psi[v] = 2*n-1;
+            besucht[v].store(v == s || v == t, std::memory_order_relaxed);
+        });
+        for (NodeId wurzel : {t, s})
+        {
+            barriere.wait();
+            if (id == 0)
+            {
+                psi[wurzel] = wurzel == t ? 0 : n;
+                ebene.assign(1, wurzel);
+                zaehler = 0;
+            }
+            barriere.wait();
+            while (!ebene.empty())
+            {
+                bloecke_abarbeiten(zaehler, ebene.size(), [&](size_t i)
+                {
+                    NodeId w = ebene[i];
+                    for (auto a = residual.first_arc(w); a < residual.first_arc(w+1); ++a)
+                    {
+                        NodeId v = residual.head(a);
+                        if (residual.residual_capacity(residual.reverse(a)) > 0 && //v->w hat Restkapazität
+                            !besucht[v].load(std::memory_order_relaxed) &&
+                            !besucht[v].exchange(1, std::memory_order_relaxed))
+                        {
+                            psi[v] = psi[w]+1;
+                            meine.gefunden.push_back(v);
+                        }
+                    }
+                });
+                barriere.wait();
+                if (id == 0)
+                {
+                    zusammenfassen(ebene);
+                    zaehler = 0;
+                }
+                barriere.wait();
+            }
+        }
+        bloecke_abarbeiten(zaehler, n, [&](NodeId v)
+        {
+            if (ist_aktiv(v))
+            {
+                meine.gefunden.push_back(v);
+            }
+        });
+        barriere.wait();
+        if (id == 0)
+        {
+            zusammenfassen(aktiv);
+            neu_berechnen = false;
+            arbeit = 0;
+            zaehler = 0;
+        }
+        barriere.wait();
+    };
+
+    parallel_for(num_threads, [&](int id)
+    {
+        ThreadDaten & meine = daten[id];
+        auto vormerken = [&](NodeId v)
+        {
+            if (!markiert[v].exchange(1, std::memory_order_relaxed))
+            {
+                meine.kandidaten.push_back(v);
+            }
+        };
+        while (true)
+        {
+            if (neu_berechnen)
+            {
+                labels_neu_berechnen(id);
+            }
+            if (aktiv.empty())
+            {
+                break;
+            }
+            //entladen mit den Labels vom Rundenbeginn
+            bloecke_abarbeiten(zaehler, aktiv.size(), [&](size_t i)
+            {
+                NodeId v = aktiv[i];
+                double rest = excess_values[v];
+                for (auto a = residual.first_arc(v); a < residual.first_arc(v+1) && rest > 0; ++a)
+                {
+                    NodeId w = residual.head(a);
+                    //erst das Label prüfen: den Bogen darf sonst gerade w verändern
+                    if (psi[v] == psi[w]+1 && residual.residual_capacity(a) > 0)
+                    {
+                        double delta = std::min(rest, residual.residual_capacity(a));
+                        residual.push(a, delta);
+                        rest -= delta;
+                        atomar_addieren(zufluss[w], delta);
+                        vormerken(w);
+                    }
+                }
+                excess_values[v] = rest;
+                if (rest > toleranz)
+                {
+                    meine.zu_relabeln.push_back(v);
+                    vormerken(v);
+                }
+            });
+            barriere.wait();
+            //relabeln, wie Flow::relabel; psi ändert sich erst im nächsten Schritt
+            for (NodeId v : meine.zu_relabeln)
+            {
+                int psi_val = 2*n-1;
+                for (auto a = residual.first_arc(v); a < residual.first_arc(v+1); ++a)
+                {
+                    if (residual.residual_capacity(a) > 0 && psi_val > psi[residual.head(a)])
+                    {
+                        psi_val = psi[residual.head(a)];
+                    }
+                }
+                neues_label[v] = psi_val+1;
+                meine.arbeit += residual.first_arc(v+1) - residual.first_arc(v) + 12;
+            }
+            meine.zu_relabeln.clear();
+            barriere.wait();
+            //Zuflüsse und neue Labels übernehmen; jeder Kandidat steht in genau einer Liste
+            for (NodeId v : meine.kandidaten)
+            {
+                if (neues_label[v] != -1)
+                {
+                    psi[v] = neues_label[v];
+                    neues_label[v] = -1;
+                }
+                excess_values[v] += zufluss[v].exchange(0, std::memory_order_relaxed);
+                markiert[v].store(0, std::memory_order_relaxed);
+                if (ist_aktiv(v))
+                {
+                    meine.gefunden.push_back(v);
+                }
+            }
+            meine.kandidaten.clear();
+            barriere.wait();
+            if (id == 0)
+            {
+                zusammenfassen(aktiv);
+                for (auto & d : daten)
+                {
+                    arbeit += d.arbeit;
+                    d.arbeit = 0;
+                }
+                neu_berechnen = global_relabel_frequency > 0 && arbeit > arbeit_grenze;
+                zaehler = 0;
+            }
+            barriere.wait();
+        }
+    });
+}
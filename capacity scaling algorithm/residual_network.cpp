@@ -0,0 +1,30 @@
+// residual_network.cpp (Implementation of Class ResidualNetwork)
+
+#include "residual_network.h"
+
+ResidualNetwork::ResidualNetwork(const Graph & network):
+  _first_arc(network.num_nodes() + 1, 0), _edge_arc(network.num_edge_ids(), -1)
+{
+   // counting sort: every vertex gets its out-arcs and the reverse arcs
+   // of its in-arcs
+   for (NodeId v = 0; v < network.num_nodes(); ++v) {
+        for (auto n: network.get_node(v).adjacent_nodes()) {
+            ++_first_arc[v + 1];
+            ++_first_arc[n.id() + 1];
+        }
+   }
+   for (NodeId v = 0; v < network.num_nodes(); ++v) {
+        _first_arc[v + 1] += _first_arc[v];
+   }
+   _arcs.resize(_first_arc.back());
+   std::vector<ArcId> next(_first_arc.begin(), _first_arc.end() - 1);
+   for (NodeId v = 0; v < network.num_nodes(); ++v) {
+        for (auto n: network.get_node(v).adjacent_nodes()) {
+            ArcId forward = next[v]++;
+            ArcId backward = next[n.id()]++;
+            _arcs[forward] = {n.id(), backward, n.edge_weight(), 0};
+            _arcs[backward] = {v, forward, 0, 0};
+            _edge_arc[n.edge_id()] = forward;
+        }
+   }
+}
@@ -0,0 +1,67 @@
+// residual_network.h (Declaration of Class ResidualNetwork)
+#ifndef RESIDUAL_NETWORK_H
+#define RESIDUAL_NETWORK_H
+
+#include <vector>
+#include "graph.h"
+
+// The residual network of a directed graph whose edge weights are
+// capacities. Every edge a->b becomes the arc a->b and the reverse arc b->a
+// with capacity 0; the two arcs know each other. The arcs leaving vertex v
+// are stored contiguously at positions first_arc(v),...,first_arc(v+1)-1,
+// and the flow is kept in the arcs themselves, so a push changes two
+// numbers and the memory stays O(m).
+class ResidualNetwork {
+public:
+  using NodeId = Graph::NodeId;
+  using ArcId = int;
+
+  ResidualNetwork(const Graph & network);
+
+  NodeId num_nodes() const { return _first_arc.size() - 1; }
+  ArcId num_arcs() const { return _arcs.size(); }
+  ArcId first_arc(NodeId v) const { return _first_arc[v]; }
+  NodeId head(ArcId a) const { return _arcs[a].head; }
+  ArcId reverse(ArcId a) const { return _arcs[a].reverse; }
+  double capacity(ArcId a) const { return _arcs[a].capacity; }
+  double flow(ArcId a) const { return _arcs[a].flow; }
+  double residual_capacity(ArcId a) const { return _arcs[a].capacity - _arcs[a].flow; }
+
+  // sends delta more units along a (and delta less along reverse(a))
+  void push(ArcId a, double delta)
+  {
+      _arcs[a].flow += delta;
+      _arcs[_arcs[a].reverse].flow -= delta;
+  }
+
+  // for a changed edge weight; the flow may exceed the new capacity
+  void set_capacity(ArcId a, double capacity)
+  {
+      _arcs[a].capacity = capacity;
+  }
+
+  // sets the flow of every arc back to 0, so the arcs can be reused
+  void clear_flow()
+  {
+      for (Arc & arc: _arcs) {
+          arc.flow = 0;
+      }
+  }
+
+  // the arc a->b created for edge e of the network
+  ArcId arc_of_edge(Graph::EdgeId e) const { return _edge_arc[e]; }
+
+private:
+  struct Arc {
+      NodeId head;
+      ArcId reverse;
+      double capacity;
+      double flow;      // antisymmetric: flow(reverse(a)) == -flow(a)
+  };
+
+  std::vector<ArcId> _first_arc;    // size num_nodes()+1
+  std::vector<Arc> _arcs;
+  std::vector<ArcId> _edge_arc;     // indexed by Graph::EdgeId
+};
+
+#endif // RESIDUAL_NETWORK_H
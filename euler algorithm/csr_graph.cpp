@@ -0,0 +1,455 @@
+// csr_graph.cpp (Implementation of Class CsrGraph)
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "csr_graph.h"
+#include "parallel.h"
+
+namespace {
+
+const char binary_magic[8] = {'E', 'D', 'M', 'G', 'R', 'A', 'P', 'H'};
+const std::uint32_t binary_version = 1;
+
+struct BinaryHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t dirtype;
+    std::int64_t num_nodes;
+    std::int64_t num_edges;
+    std::int64_t has_bvalues;
+};
+
+struct BinaryLayout {     // byte positions of the arrays; each is 8-aligned
+    BinaryLayout(const BinaryHeader & h)
+    {
+        offsets = sizeof(BinaryHeader);
+        heads = align(offsets + sizeof(CsrGraph::EdgeId) * (h.num_nodes + 1));
+        weights = align(heads + sizeof(CsrGraph::NodeId) * h.num_edges);
+        bvalues = weights + sizeof(double) * h.num_edges;
+        size = bvalues + (h.has_bvalues ? sizeof(int) * h.num_nodes : 0);
+    }
+    static size_t align(size_t pos)
+    {
+        return (pos + 7) / 8 * 8;
+    }
+    size_t offsets, heads, weights, bvalues, size;
+};
+
+// The counts must fit into NodeId and EdgeId, which also keeps BinaryLayout
+// from overflowing, and the file must be exactly as long as the arrays they
+// imply.
+bool is_valid_header(const BinaryHeader & h, size_t file_size)
+{
+    const std::int64_t max_nodes = std::numeric_limits<CsrGraph::NodeId>::max();
+    const std::int64_t max_edges = std::numeric_limits<CsrGraph::EdgeId>::max();
+    return std::memcmp(h.magic, binary_magic, sizeof(binary_magic)) == 0 and
+           h.version == binary_version and h.dirtype <= Graph::undirected and
+           h.num_nodes >= 0 and h.num_nodes <= max_nodes and
+           h.num_edges >= 0 and h.num_edges <= max_edges and
+           (h.has_bvalues == 0 or h.has_bvalues == 1) and
+           BinaryLayout(h).size == file_size;
+}
+
+}  // namespace
+
+struct CsrGraph::Storage {
+    std::vector<EdgeId> offsets;
+    std::vector<NodeId> heads;
+    std::vector<double> weights;
+    std::vector<int> bvalues;
+    void * mapping = nullptr;          // set if the arrays live in a mapped file
+    size_t mapping_size = 0;
+
+    ~Storage()
+    {
+        if (mapping != nullptr) {
+            munmap(mapping, mapping_size);
+        }
+    }
+};
+
+CsrGraph::CsrGraph(Graph::DirType dtype, std::shared_ptr<const Storage> storage):
+  dirtype(dtype), _storage(storage),
+  _num_nodes(storage->offsets.size() - 1), _num_edges(storage->heads.size()),
+  _offsets(storage->offsets.data()), _heads(storage->heads.data()),
+  _weights(storage->weights.data()),
+  _bvalues(storage->bvalues.empty() ? nullptr : storage->bvalues.data()) {}
+
+CsrGraph::CsrGraph(const Graph & g): CsrGraph(g.dirtype, [&g]() {
+   auto storage = std::make_shared<Storage>();
+   storage->offsets.resize(g.num_nodes() + 1, 0);
+   for (NodeId i = 0; i < g.num_nodes(); ++i) {
+        storage->offsets[i + 1] = storage->offsets[i] + g.get_node(i).adjacent_nodes().size();
+   }
+   storage->heads.reserve(storage->offsets.back());
+   storage->weights.reserve(storage->offsets.back());
+   for (NodeId i = 0; i < g.num_nodes(); ++i) {
+        for (auto neighbor: g.get_node(i).adjacent_nodes()) {
+            storage->heads.push_back(neighbor.id());
+            storage->weights.push_back(neighbor.edge_weight());
+        }
+   }
+   return storage;
+}()) {}
+
+CsrGraph::CsrGraph(const EdgeList & edges, Graph::DirType dtype):
+  CsrGraph(dtype, [&edges, dtype]() {
+   // counting sort of the arcs by tail; stable, so every adjacency list
+   // has the same order as Graph::add_edge would produce
+   auto storage = std::make_shared<Storage>();
+   std::vector<int> degree = edges.degrees(dtype);
+   storage->offsets.assign(edges.num_nodes + 1, 0);
+   for (NodeId i = 0; i < edges.num_nodes; ++i) {
+        storage->offsets[i + 1] = storage->offsets[i] + degree[i];
+   }
+   storage->heads.resize(storage->offsets.back());
+   storage->weights.resize(storage->offsets.back());
+   storage->bvalues = edges.bvalues;
+
+   std::vector<EdgeId> next(storage->offsets.begin(), storage->offsets.end() - 1);
+   for (int i = 0; i < edges.num_edges(); ++i) {
+        storage->heads[next[edges.tails[i]]] = edges.heads[i];
+        storage->weights[next[edges.tails[i]]++] = edges.weights[i];
+        if (dtype == Graph::undirected) {
+            storage->heads[next[edges.heads[i]]] = edges.tails[i];
+            storage->weights[next[edges.heads[i]]++] = edges.weights[i];
+        }
+   }
+   return storage;
+}()) {}
+
+CsrGraph::CsrGraph(const std::vector<EdgeList> & chunks, Graph::DirType dtype,
+                   std::vector<EdgeId> * input_order):
+  CsrGraph(dtype, [&chunks, dtype, input_order]() {
+   // parallel counting sort of the arcs by tail: thread i counts and later
+   // places the arcs of chunk i, behind those of all chunks in front of it,
+   // so the result is the same as for a single EdgeList
+   auto storage = std::make_shared<Storage>();
+   int num_chunks = chunks.size();
+   NodeId num = chunks[0].num_nodes;
+   std::vector<std::vector<int>> next(num_chunks);
+   parallel_for(num_chunks, [&](int i) {
+        next[i] = chunks[i].degrees(dtype);
+   });
+
+   // next[i][v] becomes the position of v's first arc from chunk i,
+   // relative to the first arc of v
+   storage->offsets.assign(num + 1, 0);
+   std::vector<EdgeId> part_size(num_chunks + 1, 0);
+   parallel_for(num_chunks, [&](int part) {
+        for (NodeId v = part_begin(num, num_chunks, part);
+             v < part_begin(num, num_chunks, part + 1); ++v)
+        {
+            EdgeId degree = 0;
+            for (int i = 0; i < num_chunks; ++i) {
+                EdgeId count = next[i][v];
+                next[i][v] = degree;
+                degree += count;
+            }
+            storage->offsets[v + 1] = degree;
+            part_size[part + 1] += degree;
+        }
+   });
+   for (int part = 0; part < num_chunks; ++part) {
+        part_size[part + 1] += part_size[part];
+   }
+   parallel_for(num_chunks, [&](int part) {
+        EdgeId sum = part_size[part];
+        for (NodeId v = part_begin(num, num_chunks, part);
+             v < part_begin(num, num_chunks, part + 1); ++v)
+        {
+            sum += storage->offsets[v + 1];
+            storage->offsets[v + 1] = sum;
+        }
+   });
+
+   storage->heads.resize(storage->offsets[num]);
+   storage->weights.resize(storage->offsets[num]);
+   storage->bvalues = chunks[0].bvalues;
+   std::vector<EdgeId> first_line(num_chunks + 1, 0);
+   for (int i = 0; i < num_chunks; ++i) {
+        first_line[i + 1] = first_line[i] + chunks[i].num_edges();
+   }
+   if (input_order) {
+        input_order->resize(storage->offsets[num]);
+   }
+   parallel_for(num_chunks, [&](int i) {
+        const EdgeList & edges = chunks[i];
+        std::vector<int> & pos = next[i];
+        for (int j = 0; j < edges.num_edges(); ++j) {
+            EdgeId line = first_line[i] + j;
+            EdgeId e = storage->offsets[edges.tails[j]] + pos[edges.tails[j]]++;
+            storage->heads[e] = edges.heads[j];
+            storage->weights[e] = edges.weights[j];
+            if (input_order) {
+                (*input_order)[e] = dtype == Graph::undirected ? 2 * line : line;
+            }
+            if (dtype == Graph::undirected) {
+                e = storage->offsets[edges.heads[j]] + pos[edges.heads[j]]++;
+                storage->heads[e] = edges.tails[j];
+                storage->weights[e] = edges.weights[j];
+                if (input_order) {
+                    (*input_order)[e] = 2 * line + 1;
+                }
+            }
+        }
+   });
+   return storage;
+}()) {}
+
+CsrGraph::CsrGraph(char const * filename, Graph::DirType dtype):
+  CsrGraph(load(filename, dtype)) {}
+
+CsrGraph CsrGraph::load(char const * filename, Graph::DirType dtype)
+{
+   if (not is_binary(filename)) {
+        return CsrGraph(read_edge_list_chunks(filename, default_num_threads()), dtype);
+   }
+   CsrGraph g = open_binary(filename);
+   if (g.dirtype == dtype) {
+        return g;
+   }
+   if (g.dirtype == Graph::undirected) {
+        throw std::runtime_error("Binary graph file is undirected; cannot read it as digraph.");
+   }
+   // a binary digraph read as undirected graph: every arc becomes an edge
+   EdgeList edges;
+   edges.num_nodes = g.num_nodes();
+   for (NodeId i = 0; i < g.num_nodes(); ++i) {
+        for (EdgeId e = g.first_edge(i); e < g.first_edge(i + 1); ++e) {
+            edges.tails.push_back(i);
+            edges.heads.push_back(g.head(e));
+            edges.weights.push_back(g.weight(e));
+        }
+   }
+   if (g.has_bvalues()) {
+        edges.bvalues.assign(g._bvalues, g._bvalues + g.num_nodes());
+   }
+   return CsrGraph(edges, dtype);
+}
+
+CsrGraph::NodeId CsrGraph::num_nodes() const
+{
+   return _num_nodes;
+}
+
+CsrGraph::EdgeId CsrGraph::num_edges() const
+{
+   return _num_edges;
+}
+
+CsrGraph::Node CsrGraph::get_node(NodeId node) const
+{
+   if (node < 0 or node >= num_nodes()) {
+        throw std::runtime_error("Invalid nodeid in CsrGraph::get_node.");
+   }
+   return Node(this, node);
+}
+
+CsrGraph::NeighborRange CsrGraph::adjacent_nodes(NodeId node) const
+{
+   return NeighborRange(this, _offsets[node], _offsets[node + 1]);
+}
+
+std::vector<CsrGraph::EdgeId> CsrGraph::reverse_edges() const
+{
+   std::vector<EdgeId> reverse(num_edges(), Graph::invalid_edge);
+   if (dirtype == Graph::directed) {
+        return reverse;
+   }
+   // the k-th arc u->v is paired with the k-th arc v->u; for every pair u<v
+   // the unmatched arcs u->v are kept in a list linked by next
+   std::vector<EdgeId> next(num_edges(), Graph::invalid_edge);
+   std::unordered_map<std::uint64_t, std::pair<EdgeId, EdgeId>> unmatched;  // first, last
+   auto key = [](NodeId u, NodeId v) {
+        return (static_cast<std::uint64_t>(u) << 32) | static_cast<std::uint32_t>(v);
+   };
+   for (NodeId u = 0; u < num_nodes(); ++u) {
+        for (EdgeId e = first_edge(u); e < first_edge(u + 1); ++e) {
+            if (u < head(e)) {
+                auto it = unmatched.find(key(u, head(e)));
+                if (it == unmatched.end()) {
+                    unmatched.emplace(key(u, head(e)), std::make_pair(e, e));
+                } else {
+                    next[it->second.second] = e;
+                    it->second.second = e;
+                }
+            }
+        }
+   }
+   for (NodeId v = 0; v < num_nodes(); ++v) {
+        for (EdgeId e = first_edge(v); e < first_edge(v + 1); ++e) {
+            auto it = head(e) < v ? unmatched.find(key(head(e), v)) : unmatched.end();
+            if (it != unmatched.end()) {
+                EdgeId f = it->second.first;
+                reverse[e] = f;
+                reverse[f] = e;
+                if (next[f] == Graph::invalid_edge) {
+                    unmatched.erase(it);
+                } else {
+                    it->second.first = next[f];
+                }
+            }
+        }
+   }
+   return reverse;
+}
+
+CsrGraph CsrGraph::reverse() const
+{
+   if (dirtype == Graph::undirected) {
+        return *this;
+   }
+   // counting sort of the arcs by head; the arcs entering v keep the order
+   // of their tails
+   auto storage = std::make_shared<Storage>();
+   storage->offsets.assign(num_nodes() + 1, 0);
+   for (EdgeId e = 0; e < num_edges(); ++e) {
+        ++storage->offsets[head(e) + 1];
+   }
+   for (NodeId v = 0; v < num_nodes(); ++v) {
+        storage->offsets[v + 1] += storage->offsets[v];
+   }
+   storage->heads.resize(num_edges());
+   storage->weights.resize(num_edges());
+   if (has_bvalues()) {
+        storage->bvalues.assign(_bvalues, _bvalues + num_nodes());
+   }
+   std::vector<EdgeId> next(storage->offsets.begin(), storage->offsets.end() - 1);
+   for (NodeId u = 0; u < num_nodes(); ++u) {
+        for (EdgeId e = first_edge(u); e < first_edge(u + 1); ++e) {
+            storage->heads[next[head(e)]] = u;
+            storage->weights[next[head(e)]++] = weight(e);
+        }
+   }
+   return CsrGraph(dirtype, storage);
+}
+
+void CsrGraph::print() const
+{
+   if (dirtype == Graph::directed) {
+        std::cout << "Digraph ";
+   } else {
+        std::cout << "Undirected graph ";
+   }
+   std::cout << "with " << num_nodes() << " vertices, numbered 0,...,"
+              << num_nodes() - 1 << ".\n";
+
+   for (auto nodeid = 0; nodeid < num_nodes(); ++nodeid) {
+        std::cout << "The following edges are ";
+        if (dirtype == Graph::directed) {
+            std::cout << "leaving";
+        } else {
+            std::cout << "incident to";
+        }
+        std::cout << " vertex " << nodeid << ":\n";
+        for (auto neighbor: adjacent_nodes(nodeid)) {
+            std::cout << nodeid << " - " << neighbor.id()
+                      << " weight = " << neighbor.edge_weight() << "\n";
+        }
+   }
+}
+
+bool CsrGraph::is_binary(char const * filename)
+{
+   std::ifstream file(filename, std::ios::binary);
+   char magic[sizeof(binary_magic)];
+   return file.read(magic, sizeof(magic)) and
+          std::memcmp(magic, binary_magic, sizeof(magic)) == 0;
+}
+
+void CsrGraph::write_binary(char const * filename) const
+{
+   BinaryHeader header;
+   std::memcpy(header.magic, binary_magic, sizeof(binary_magic));
+   header.version = binary_version;
+   header.dirtype = dirtype;
+   header.num_nodes = num_nodes();
+   header.num_edges = num_edges();
+   header.has_bvalues = has_bvalues();
+   BinaryLayout layout(header);
+
+   std::ofstream file(filename, std::ios::binary);
+   if (not file) {
+        throw std::runtime_error("Cannot open file.");
+   }
+   auto write_at = [&file](size_t pos, const void * data, size_t bytes) {
+        while (static_cast<size_t>(file.tellp()) < pos) {
+            file.put('\0');                   // padding
+        }
+        file.write(static_cast<const char *>(data), bytes);
+   };
+   write_at(0, &header, sizeof(header));
+   write_at(layout.offsets, _offsets, sizeof(EdgeId) * (num_nodes() + 1));
+   write_at(layout.heads, _heads, sizeof(NodeId) * num_edges());
+   write_at(layout.weights, _weights, sizeof(double) * num_edges());
+   if (has_bvalues()) {
+        write_at(layout.bvalues, _bvalues, sizeof(int) * num_nodes());
+   }
+   if (not file) {
+        throw std::runtime_error("Cannot write file.");
+   }
+}
+
+CsrGraph CsrGraph::open_binary(char const * filename)
+{
+   int fd = open(filename, O_RDONLY);
+   if (fd < 0) {
+        throw std::runtime_error("Cannot open file.");
+   }
+   // the header is checked before anything is mapped, so that damaged
+   // counts cannot make the arrays reach beyond the end of the file
+   struct stat info;
+   BinaryHeader header;
+   if (fstat(fd, &info) != 0 or
+       pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) or
+       not is_valid_header(header, info.st_size))
+   {
+        close(fd);
+        throw std::runtime_error("Invalid binary graph file.");
+   }
+   auto storage = std::make_shared<Storage>();
+   storage->mapping_size = info.st_size;
+   storage->mapping = mmap(nullptr, storage->mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+   close(fd);                                // the mapping stays valid
+   if (storage->mapping == MAP_FAILED) {
+        storage->mapping = nullptr;
+        throw std::runtime_error("Cannot map file.");
+   }
+
+   const char * base = static_cast<const char *>(storage->mapping);
+   BinaryLayout layout(header);
+
+   CsrGraph g(static_cast<Graph::DirType>(header.dirtype), storage);
+   g._num_nodes = header.num_nodes;
+   g._num_edges = header.num_edges;
+   g._offsets = reinterpret_cast<const EdgeId *>(base + layout.offsets);
+   g._heads = reinterpret_cast<const NodeId *>(base + layout.heads);
+   g._weights = reinterpret_cast<const double *>(base + layout.weights);
+   g._bvalues = header.has_bvalues ? reinterpret_cast<const int *>(base + layout.bvalues) : nullptr;
+
+   // the arrays are used without further checks, so a damaged file must not
+   // get past this point
+   if (g._offsets[0] != 0 or g._offsets[g._num_nodes] != g._num_edges) {
+        throw std::runtime_error("Invalid binary graph file.");
+   }
+   for (NodeId v = 0; v < g._num_nodes; ++v) {
+        if (g._offsets[v] > g._offsets[v + 1]) {
+            throw std::runtime_error("Invalid binary graph file.");
+        }
+   }
+   for (EdgeId e = 0; e < g._num_edges; ++e) {
+        if (g._heads[e] < 0 or g._heads[e] >= g._num_nodes) {
+            throw std::runtime_error("Invalid binary graph file.");
+        }
+   }
+   return g;
+}
@@ -0,0 +1,119 @@
+// csr_graph.h (Declaration of Class CsrGraph)
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include <memory>
+#include <vector>
+#include "graph.h"
+#include "graph_reader.h"
+
+// A frozen graph in compressed sparse row format: the arcs leaving vertex v
+// are stored contiguously at positions first_edge(v),...,first_edge(v+1)-1
+// of one head array and one weight array. Undirected edges are stored twice.
+class CsrGraph {
+public:
+  using NodeId = Graph::NodeId;
+  using EdgeId = int;  // arcs are numbered 0,...,num_edges()-1
+
+  class NeighborIterator {
+  public:
+        NeighborIterator(const CsrGraph * g, EdgeId e): _graph(g), _edge(e) {}
+        Graph::Neighbor operator* () const
+        {
+            return Graph::Neighbor(_graph->head(_edge), _graph->weight(_edge), _edge);
+        }
+        NeighborIterator & operator++ ()
+        {
+            ++_edge;
+            return *this;
+        }
+        bool operator!= (const NeighborIterator & other) const
+        {
+            return _edge != other._edge;
+        }
+  private:
+        const CsrGraph * _graph;
+        EdgeId _edge;
+    };
+
+  class NeighborRange {
+  public:
+        NeighborRange(const CsrGraph * g, EdgeId first, EdgeId last):
+          _graph(g), _first(first), _last(last) {}
+        NeighborIterator begin() const { return NeighborIterator(_graph, _first); }
+        NeighborIterator end() const { return NeighborIterator(_graph, _last); }
+        EdgeId size() const { return _last - _first; }
+        bool empty() const { return _first == _last; }
+  private:
+        const CsrGraph * _graph;
+        EdgeId _first;
+        EdgeId _last;
+    };
+
+  // lightweight view, so that code written for Graph::Node works unchanged
+  class Node {
+  public:
+        Node(const CsrGraph * g, NodeId id): _graph(g), _id(id) {}
+        NeighborRange adjacent_nodes() const { return _graph->adjacent_nodes(_id); }
+  private:
+        const CsrGraph * _graph;
+        NodeId _id;
+    };
+
+  CsrGraph(const Graph & g);
+  CsrGraph(const EdgeList & edges, Graph::DirType dirtype);
+  // builds the arrays on one thread per chunk (see read_edge_list_chunks);
+  // if input_order is given, it receives for every arc its number in the
+  // order of the input lines, as Graph::add_edge_list numbers them (for
+  // undirected graphs the arc at the tail of line i is 2i, its mirror 2i+1)
+  CsrGraph(const std::vector<EdgeList> & chunks, Graph::DirType dirtype,
+           std::vector<EdgeId> * input_order = nullptr);
+  // reads an edge list file, or maps a binary graph file (see write_binary)
+  CsrGraph(char const * filename, Graph::DirType dirtype);
+
+  NodeId num_nodes() const;
+  EdgeId num_edges() const;
+  Node get_node(NodeId node) const;
+  NeighborRange adjacent_nodes(NodeId node) const;
+
+  EdgeId first_edge(NodeId node) const { return _offsets[node]; }
+  NodeId head(EdgeId e) const { return _heads[e]; }
+  double weight(EdgeId e) const { return _weights[e]; }
+  // for undirected graphs: the arc v->u that stores the same edge as arc
+  // u->v (loops and unpaired arcs get Graph::invalid_edge)
+  std::vector<EdgeId> reverse_edges() const;
+  // the graph with every arc turned around, e.g. for searches towards a
+  // target; an undirected graph is its own reverse and shares its arrays
+  CsrGraph reverse() const;
+
+  bool has_bvalues() const { return _bvalues != nullptr; }
+  int bvalue(NodeId node) const { return _bvalues[node]; }
+
+  void print() const;
+
+  // Binary format: a header followed by the offsets, heads, weights and
+  // (optionally) b-values exactly as they are laid out in memory, so that
+  // open_binary can mmap the file and use it without parsing or copying.
+  void write_binary(char const * filename) const;
+  static CsrGraph open_binary(char const * filename);
+  static bool is_binary(char const * filename);
+
+  const Graph::DirType dirtype;
+
+private:
+  struct Storage;     // owns the arrays, either as vectors or as a mapping
+
+  CsrGraph(Graph::DirType dirtype, std::shared_ptr<const Storage> storage);
+  static CsrGraph load(char const * filename, Graph::DirType dirtype);
+  void build(const EdgeList & edges);
+
+  std::shared_ptr<const Storage> _storage;   // shared, since it is never modified
+  NodeId _num_nodes;
+  EdgeId _num_edges;
+  const EdgeId * _offsets;   // size num_nodes()+1
+  const NodeId * _heads;
+  const double * _weights;
+  const int * _bvalues;      // nullptr if the graph has no b-values
+};
+
+#endif // CSR_GRAPH_H
@@ -1,4 +1,5 @@
 #include "graph.h"
+#include "csr_graph.h"
 
 void euler(Graph &g, Graph::NodeId start, std::vector<Graph::NodeId> &tour)
 {
@@ -6,8 +7,9 @@ void euler(Graph &g, Graph::NodeId start, std::vector<Graph::NodeId> &tour)
   std::vector<Graph::NodeId> kantenzug;
   while (!g.get_node(cur).adjacent_nodes().empty())
   {
-    Graph::NodeId neighbor = g.get_node(cur).adjacent_nodes().back().id();
-    g.remove_edge(cur, neighbor);
+    Graph::Neighbor last = g.get_node(cur).adjacent_nodes().back();
+    Graph::NodeId neighbor = last.id();
+    g.remove_edge(last.edge_id());  // O(1), die Gegenkante wird mit entfernt
     kantenzug.push_back(neighbor);
     cur = neighbor;
   }
@@ -22,13 +24,57 @@ void euler(Graph &g, Graph::NodeId start, std::vector<Graph::NodeId> &tour)
     }
 }
 
+void euler(const CsrGraph &g, Graph::NodeId start, std::vector<Graph::NodeId> &tour)
+{ // Same tour as above, but the arcs of a vertex are used up by moving a cursor
+  // from the back of its arc range instead of removing them, and the
+  // recursion is replaced by an explicit stack.
+  if (g.dirtype != Graph::directed)
+  {
+    throw "Euler-Touren auf CsrGraph sind nur für gerichtete Graphen implementiert.";
+  }
+  std::vector<CsrGraph::EdgeId> cursor(g.num_nodes());
+  for (Graph::NodeId i = 0; i < g.num_nodes(); ++i)
+  {
+    cursor[i] = g.first_edge(i + 1);
+  }
+  auto kantenzug = [&](Graph::NodeId cur)
+  {
+    std::vector<Graph::NodeId> walk;
+    Graph::NodeId from = cur;
+    while (cursor[cur] > g.first_edge(cur))
+    {
+      cur = g.head(--cursor[cur]);
+      walk.push_back(cur);
+    }
+    if ((not walk.empty()) && (from != walk.back()))
+    {
+      throw "Der Graph ist nicht eulersch, weil es existiert Kanten mit ungeradem Grad.";
+    }
+    return walk;
+  };
+
+  std::vector<std::pair<std::vector<Graph::NodeId>, size_t>> stack;
+  stack.push_back({kantenzug(start), 0});
+  while (!stack.empty())
+  {
+    if (stack.back().second == stack.back().first.size())
+    {
+      stack.pop_back();
+      continue;
+    }
+    Graph::NodeId next = stack.back().first[stack.back().second++];
+    tour.push_back(next);
+    stack.push_back({kantenzug(next), 0});
+  }
+}
+
 int main(int argc, char* argv[])
 {	
 	if (argc > 1) 
   {
     try
     {
-      Graph g(argv[1], Graph::directed);
+      CsrGraph g(argv[1], Graph::directed);
       Graph::NodeId start = 0;
 
       while(start < g.num_nodes() && g.get_node(start).adjacent_nodes().empty())
@@ -42,12 +88,9 @@ int main(int argc, char* argv[])
 
     	std::vector<Graph::NodeId> main_euler={start};
       euler(g, start, main_euler);
-      for (int i = 0; i < g.num_nodes(); ++i)
+      if (main_euler.size() != static_cast<size_t>(g.num_edges()) + 1)
       {
-        if (!g.get_node(i).adjacent_nodes().empty())
-        {
-          throw "Der Graph ist nicht eulersch, da er nicht stark zusammenhängend ist.";
-        }
+        throw "Der Graph ist nicht eulersch, da er nicht stark zusammenhängend ist.";
       }
       for (Graph::NodeId i : main_euler)
       {
@@ -0,0 +1,34 @@
+// graph_convert.cpp (Converts an edge list file into a binary graph file)
+
+#include <cstring>
+#include <iostream>
+#include "csr_graph.h"
+
+int main(int argc, char * argv[])
+{
+    if (argc < 3) {
+        std::cout << "Usage: " << argv[0]
+                  << " input output [directed|undirected] [bvalues]\n"
+                  << "Writes the graph in the binary format that all programs\n"
+                  << "accept in place of the edge list file. Digraph files can\n"
+                  << "also be read as undirected graphs. Use bvalues if the\n"
+                  << "input lists one b-value per vertex before the edges.\n";
+        return 1;
+    }
+    Graph::DirType dirtype = Graph::directed;
+    bool with_bvalues = false;
+    for (int i = 3; i < argc; ++i) {
+        if (std::strcmp(argv[i], "undirected") == 0) {
+            dirtype = Graph::undirected;
+        } else if (std::strcmp(argv[i], "bvalues") == 0) {
+            with_bvalues = true;
+        } else if (std::strcmp(argv[i], "directed") != 0) {
+            std::cout << "Unknown option " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+    CsrGraph g(read_edge_list(argv[1], with_bvalues), dirtype);
+    g.write_binary(argv[2]);
+    std::cout << "Wrote " << g.num_nodes() << " vertices and " << g.num_edges()
+              << " arcs to " << argv[2] << ".\n";
+}
@@ -0,0 +1,175 @@
+// graph_reader.cpp (Bulk Reader for Edge List Files)
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include "graph_reader.h"
+#include "parallel.h"
+
+namespace {
+
+class Scanner {     // walks over the file contents line by line
+public:
+    Scanner(const char * begin, const char * end): _pos(begin), _end(end) {}
+
+    bool at_end() const
+    {
+        return _pos == _end;
+    }
+
+    const char * position() const
+    {
+        return _pos;
+    }
+
+    template <typename T>
+    bool read(T & value)        // reads the next number of the current line
+    {
+        while (_pos != _end and (*_pos == ' ' or *_pos == '\t' or *_pos == '\r')) {
+            ++_pos;
+        }
+        auto result = std::from_chars(_pos, _end, value);
+        if (result.ec != std::errc()) {
+            return false;
+        }
+        _pos = result.ptr;
+        return true;
+    }
+
+    void next_line()            // skips the rest of the current line
+    {
+        _pos = std::find(_pos, _end, '\n');
+        if (_pos != _end) {
+            ++_pos;
+        }
+    }
+
+private:
+    const char * _pos;
+    const char * _end;
+};
+
+std::string read_file(char const * filename)
+{
+   std::ifstream file(filename, std::ios::binary);
+   if (not file) {
+        throw std::runtime_error("Cannot open file.");
+   }
+   file.seekg(0, std::ios::end);
+   std::string contents(static_cast<size_t>(file.tellg()), '\0');
+   file.seekg(0, std::ios::beg);
+   file.read(&contents[0], contents.size());
+   return contents;
+}
+
+}  // namespace
+
+
+std::vector<int> EdgeList::degrees(Graph::DirType dirtype) const
+{
+   std::vector<int> degree(num_nodes, 0);
+   for (int i = 0; i < num_edges(); ++i) {
+        ++degree[tails[i]];
+        if (dirtype == Graph::undirected) {
+            ++degree[heads[i]];
+        }
+   }
+   return degree;
+}
+
+EdgeList read_edge_list(char const * filename, bool with_bvalues, bool with_costs)
+{
+   return std::move(read_edge_list_chunks(filename, 1, with_bvalues, with_costs)[0]);
+}
+
+std::vector<EdgeList> read_edge_list_chunks(char const * filename, int num_chunks,
+                                            bool with_bvalues, bool with_costs)
+{
+   std::string contents = read_file(filename);
+   const char * begin = contents.data();
+   const char * end = begin + contents.size();
+   Scanner scanner(begin, end);
+
+   Graph::NodeId num_nodes;
+   if (not scanner.read(num_nodes)) {
+        throw std::runtime_error("Invalid file format.");
+   }
+   scanner.next_line();
+
+   std::vector<int> bvalues;
+   if (with_bvalues) {
+        bvalues.resize(num_nodes);
+        for (auto & b: bvalues) {
+            if (not scanner.read(b)) {
+                throw std::runtime_error("Invalid file format.");
+            }
+            scanner.next_line();
+        }
+   }
+
+   // split the edge lines into byte ranges that end with a newline
+   const char * first = scanner.position();
+   const long long min_chunk_size = 1 << 20;
+   num_chunks = std::max(1LL, std::min<long long>(num_chunks, (end - first) / min_chunk_size));
+   std::vector<const char *> bounds(num_chunks + 1, end);
+   bounds[0] = first;
+   for (int i = 1; i < num_chunks; ++i) {
+        bounds[i] = std::find(std::max(first + (end - first) * i / num_chunks, bounds[i - 1]),
+                              end, '\n');
+        if (bounds[i] != end) {
+            ++bounds[i];
+        }
+   }
+
+   std::vector<int> num_lines(num_chunks);
+   parallel_for(num_chunks, [&](int i) {
+        num_lines[i] = std::count(bounds[i], bounds[i + 1], '\n');
+   });
+
+   std::vector<EdgeList> chunks(num_chunks);
+   parallel_for(num_chunks, [&](int i) {
+        int linenum = 0;                 // edge lines in front of this chunk
+        for (int j = 0; j < i; ++j) {
+            linenum += num_lines[j];
+        }
+        EdgeList & edges = chunks[i];
+        edges.num_nodes = num_nodes;
+        edges.tails.reserve(num_lines[i] + 1);
+        edges.heads.reserve(num_lines[i] + 1);
+        edges.weights.reserve(num_lines[i] + 1);
+        if (with_costs) {
+            edges.costs.reserve(num_lines[i] + 1);
+        }
+
+        Scanner scanner(bounds[i], bounds[i + 1]);
+        while (not scanner.at_end()) {
+            Graph::NodeId tail, head;
+            if (not (scanner.read(tail) and scanner.read(head))) {
+                throw std::runtime_error("Invalid file format at line " + std::to_string(linenum));
+            }
+            double weight = 1.0;
+            double cost = 0.0;
+            if (scanner.read(weight) and with_costs) {   // the weight is optional
+                scanner.read(cost);
+            }
+            if (tail == head) {
+                throw std::runtime_error("Invalid file format: loops not allowed.");
+            }
+            if (tail >= num_nodes or tail < 0 or head >= num_nodes or head < 0) {
+                throw std::runtime_error("Edge cannot be added due to undefined endpoint.");
+            }
+            edges.tails.push_back(tail);
+            edges.heads.push_back(head);
+            edges.weights.push_back(weight);
+            if (with_costs) {
+                edges.costs.push_back(cost);
+            }
+            scanner.next_line();
+            linenum++;
+        }
+   });
+   chunks[0].bvalues = std::move(bvalues);
+   return chunks;
+}
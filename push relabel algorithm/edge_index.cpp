@@ -0,0 +1,112 @@
+// edge_index.cpp (Hash Index for Edge Lookups)
+
+#include <cstdint>
+#include "edge_index.h"
+
+namespace {
+const EdgeIndex::NodeId empty_slot = -1;
+const std::size_t initial_size = 16;
+}
+
+EdgeIndex::EdgeIndex(): _table(initial_size, {empty_slot, empty_slot, 0, 0}), _num_entries(0) {}
+
+std::size_t EdgeIndex::home_slot(NodeId tail, NodeId head) const
+{
+    std::uint64_t key = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(tail)) << 32)
+                        | static_cast<std::uint32_t>(head);
+    key ^= key >> 33;                   // mix all bits into the low ones
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return key & (_table.size() - 1);
+}
+
+std::size_t EdgeIndex::find_slot(NodeId tail, NodeId head) const
+{
+    std::size_t slot = home_slot(tail, head);
+    while (_table[slot].tail != empty_slot and
+           (_table[slot].tail != tail or _table[slot].head != head))
+    {
+        slot = (slot + 1) & (_table.size() - 1);
+    }
+    return slot;
+}
+
+int EdgeIndex::edge(NodeId tail, NodeId head) const
+{
+    const Entry & entry = _table[find_slot(tail, head)];
+    return entry.tail == empty_slot ? -1 : entry.edge;
+}
+
+int EdgeIndex::count(NodeId tail, NodeId head) const
+{
+    const Entry & entry = _table[find_slot(tail, head)];
+    return entry.tail == empty_slot ? 0 : entry.count;
+}
+
+void EdgeIndex::insert(NodeId tail, NodeId head, int edge)
+{
+    if (2 * (_num_entries + 1) > _table.size()) {   // keep the load below 1/2
+        grow();
+    }
+    Entry & entry = _table[find_slot(tail, head)];
+    if (entry.tail == empty_slot) {
+        entry = {tail, head, edge, 0};
+        ++_num_entries;
+    }
+    ++entry.count;
+}
+
+void EdgeIndex::set_edge(NodeId tail, NodeId head, int edge)
+{
+    Entry & entry = _table[find_slot(tail, head)];
+    if (entry.tail != empty_slot) {
+        entry.edge = edge;
+    }
+}
+
+void EdgeIndex::erase(NodeId tail, NodeId head)
+{
+    std::size_t slot = find_slot(tail, head);
+    if (_table[slot].tail == empty_slot or --_table[slot].count > 0) {
+        return;
+    }
+    // backward shift deletion: move later entries of the probe sequence
+    // into the gap, so that no tombstones are needed
+    std::size_t mask = _table.size() - 1;
+    std::size_t next = slot;
+    while (true) {
+        next = (next + 1) & mask;
+        if (_table[next].tail == empty_slot) {
+            break;
+        }
+        std::size_t home = home_slot(_table[next].tail, _table[next].head);
+        if (((next - home) & mask) >= ((next - slot) & mask)) {
+            _table[slot] = _table[next];
+            slot = next;
+        }
+    }
+    _table[slot].tail = empty_slot;
+    --_num_entries;
+}
+
+void EdgeIndex::clear()
+{
+    _table.assign(initial_size, {empty_slot, empty_slot, 0, 0});
+    _num_entries = 0;
+}
+
+void EdgeIndex::grow()
+{
+    std::vector<Entry> old_table(2 * _table.size(), {empty_slot, empty_slot, 0, 0});
+    old_table.swap(_table);
+    for (const Entry & entry: old_table) {
+        if (entry.tail != empty_slot) {
+            _table[find_slot(entry.tail, entry.head)] = entry;
+        }
+    }
+}
+
+std::size_t EdgeIndex::memory_usage() const
+{
+    return sizeof(*this) + _table.capacity() * sizeof(Entry);
+}
@@ -0,0 +1,41 @@
+// edge_index.h (Hash Index for Edge Lookups)
+#ifndef EDGE_INDEX_H
+#define EDGE_INDEX_H
+
+#include <cstddef>
+#include <vector>
+
+// Open addressing hash table with linear probing. For every pair
+// (tail, head) with at least one arc it stores the number of these arcs
+// and the id of the first one (see Graph::EdgeId).
+class EdgeIndex {
+public:
+    using NodeId = int;
+
+    EdgeIndex();
+
+    int edge(NodeId tail, NodeId head) const;       // -1 if there is no arc
+    int count(NodeId tail, NodeId head) const;
+    void insert(NodeId tail, NodeId head, int edge);       // adds one arc
+    void erase(NodeId tail, NodeId head);                  // removes one arc
+    void set_edge(NodeId tail, NodeId head, int edge);
+    void clear();
+    std::size_t memory_usage() const;                // in bytes
+
+private:
+    struct Entry {
+        NodeId tail;           // invalid_node marks an empty slot
+        NodeId head;
+        int edge;
+        int count;
+    };
+
+    std::size_t home_slot(NodeId tail, NodeId head) const;
+    std::size_t find_slot(NodeId tail, NodeId head) const;   // or the empty slot
+    void grow();
+
+    std::vector<Entry> _table;        // the size is a power of two
+    std::size_t _num_entries;
+};
+
+#endif // EDGE_INDEX_H
@@ -1,144 +1,783 @@
 //flow.cpp
 #include "flow.h"
+#include "label_buckets.h"
+#include "parallel.h"
 #include <vector>
 #include <limits>
 #include <stdexcept>
 #include <algorithm>
+#include <cmath>
 
+// Netzwerke benutzen den Kantenindex, damit get_capacity nicht den ganzen Grad durchläuft.
+// Mit disable_edge_index() lässt er sich abschalten.
 Network::Network(NodeId num_nodes) : Graph(num_nodes, Graph::DirType::directed){
+    enable_edge_index();
 }
 Network::Network(const char* filename) : Graph(filename, Graph::DirType::directed) {
+    enable_edge_index();
+}
+Network::Network(const CsrGraph & g) : Graph(g.num_nodes(), Graph::DirType::directed) {
+    enable_edge_index();
+    // Ein ungerichteter CsrGraph enthält jede Kante zweimal, also eine Kante pro Richtung.
+    for (Graph::NodeId i = 0; i < g.num_nodes(); ++i){
+        for (auto n : g.adjacent_nodes(i)){
+            add_edge(i, n.id(), n.edge_weight());
+        }
+    }
 }
 // Setzt die Kapazität einer Kante
 void Network::set_capacity(NodeId a, NodeId b, double c){
-    //Falls eine Kante bereits existiert, so wird diese entfernt
-    if(get_capacity(a,b) != 0){
-        remove_edge(a,b);
+    //Falls eine Kante bereits existiert, wird ihre Kapazität an Ort und Stelle geändert, so bleibt ihre Id gültig
+    EdgeId e = find_edge(a, b);
+    if (e != invalid_edge){
+        set_edge_weight(e, c);
+        return;
     }
     //Erstellt eine neue Kante und fügt diese hinzu
-    Graph::Edge e(a, b, c);
-    add_edge(e);
+    Graph::Edge kante(a, b, c);
+    add_edge(kante);
 }
 
-void Flow::relabel(NodeId v, std::vector<int> &psi, Graph * residual){
-    int psi_val = num_nodes()*2-1;
-    for (auto n : residual->get_node(v).adjacent_nodes()){
-        if (psi_val > psi[n.id()])
+void Flow::relabel(NodeId v, std::vector<int> &psi, const ResidualNetwork & residual){
+    int psi_val = residual.num_nodes()*2-1;
+    for (auto a = residual.first_arc(v); a < residual.first_arc(v+1); ++a){
+        if (residual.residual_capacity(a) > 0 && psi_val > psi[residual.head(a)])
         {
-            psi_val = psi[n.id()];
+            psi_val = psi[residual.head(a)];
         }
     }
     psi[v] = psi_val+1;
 }
 
-void Flow::push(NodeId s, NodeId t, Graph * residual, std::vector<double> & excess_values){
-    //double res_capacity = residual->get_edge(s, t).weight();
-    double res_capacity=0; //= residual->get_edge(s, t).weight();
-    //da es parallele Kanten existieren, Residualkapazität ist die Summe aller Kapazitäten der Kanten.
-    for (auto n : residual->get_node(s).adjacent_nodes())
+void Flow::push(ResidualNetwork & residual, ResidualNetwork::ArcId a, std::vector<double> & excess_values){
+    NodeId s = residual.head(residual.reverse(a));
+    NodeId t = residual.head(a);
+    double gamma = std::min(excess_values[s], residual.residual_capacity(a));
+    //aktualisiere den Residualgraphen: nur Fluss auf a und dem Rückwärtsbogen ändert sich
+    residual.push(a, gamma);
+    excess_values[s] -= gamma;
+    excess_values[t] +=gamma;
+}
+
+void Network::labels_berechnen(NodeId s, NodeId t, Reparaturzustand & zustand){
+    //psi wird der Abstand nach t im Residualgraphen; wer t nicht erreicht, bekommt n + Abstand nach s
+    int n = num_nodes();
+    const ResidualNetwork & residual = zustand.residual;
+    std::vector<int> & psi = zustand.psi;
+    std::vector<bool> & besucht = zustand.puffer.besucht;
+    std::vector<NodeId> & schlange = zustand.puffer.schlange;
+    std::fill(besucht.begin(), besucht.end(), false);
+    auto breitensuche = [&](NodeId wurzel)
     {
-        if (n.id()==t)
+        schlange.assign(1, wurzel);
+        for (size_t i = 0; i < schlange.size(); ++i)
         {
-            res_capacity+=n.edge_weight();
+            NodeId w = schlange[i];
+            for (auto a = residual.first_arc(w); a < residual.first_arc(w+1); ++a)
+            {
+                NodeId v = residual.head(a);
+                if (!besucht[v] && residual.residual_capacity(residual.reverse(a)) > 0) //v->w hat Restkapazität
+                {
+                    besucht[v] = true;
+                    psi[v] = psi[w]+1;
+                    schlange.push_back(v);
+                }
+            }
         }
+    };
+    std::fill(psi.begin(), psi.end(), 2*n-1); //unerreichbare Knoten können keinen Überschuss haben
+    besucht[s] = besucht[t] = true;
+    psi[s] = n;
+    psi[t] = 0;
+    breitensuche(t);
+    breitensuche(s);
+}
+
+void Network::saettige_quelle(NodeId s, ResidualNetwork & residual, std::vector<double> & excess_values){
+    for (auto a = residual.first_arc(s); a < residual.first_arc(s+1); ++a)
+    {
+        double capacity = residual.residual_capacity(a);
+        residual.push(a, capacity); //all neighbors of s get the flow as much as capacity
+        excess_values[residual.head(a)] += capacity;
+        excess_values[s] -= capacity;
     }
-    double gamma = std::min(excess_values[s], res_capacity);
-    //aktualisiere den Residualgraphen
-    residual->add_edge(t,s,gamma);
-    residual->remove_edge(s,t);
-    if (res_capacity>gamma)
+}
+
+//Rundungsreste kleiner als die Toleranz machen einen Knoten nicht aktiv, sonst könnten sie endlos hin und her gelabelt werden
+double Network::ueberschuss_toleranz(NodeId s, const ResidualNetwork & residual){
+    double toleranz = 0;
+    for (auto a = residual.first_arc(s); a < residual.first_arc(s+1); ++a)
     {
-        residual->add_edge(s,t,res_capacity-gamma);
+        toleranz += residual.capacity(a) * 1e-12;
     }
-    excess_values[s] -= gamma;
-    excess_values[t] +=gamma;
-    set_usage(s, t, gamma);
+    return toleranz;
 }
 
-Flow* Network::push_relabel(NodeId s, NodeId t){
-    Flow* f = new Flow(this, s, t);
-    //1&2
-    std::vector<int> psi(num_nodes(),0); //init psi
-    std::vector<double> excess_values(num_nodes(),0);
-    psi[0] = num_nodes(); //init psi(s)
-    Graph * residual = f->residual_graph();
-    for (auto n : get_node(s).adjacent_nodes())
-    {
-        double capacity = get_capacity(s,n.id());
-        f->set_usage(s,n.id(), capacity); //all neighbors of s get the flow as much as capacity
-        excess_values[n.id()] = capacity;
-        excess_values[s] -= capacity;
+Entladepuffer::Entladepuffer(Graph::NodeId n):
+    aktive_knoten(n, 2*n), ebenen(n, n), aktueller_bogen(n), ist_geaendert(n, false), besucht(n, false) {}
+
+void Entladepuffer::markiere(Graph::NodeId v){
+    if (!ist_geaendert[v])
+    {
+        ist_geaendert[v] = true;
+        geaendert.push_back(v);
     }
-    residual = f->residual_graph();
-    std::vector<NodeId> aktive_knoten;  //vector of active nodes
+}
 
-    for (int i = 0; i < num_nodes(); ++i) 
+void Entladepuffer::markierungen_loeschen(){
+    for (auto v : geaendert)
     {
-        if (excess_values[i]>0 && i != t) //activity of all nodes are significant except t.
+        ist_geaendert[v] = false;
+    }
+    geaendert.clear();
+}
+
+Reparaturzustand::Reparaturzustand(const Graph & network):
+    residual(network), excess_values(network.num_nodes(), 0), psi(network.num_nodes(), 0),
+    puffer(network.num_nodes()),
+    vorgaenger(network.num_nodes(), -1), version(network.version()) {}
+
+// Push-Relabel, bis kein Knoten mit psi < grenze mehr Überschuss hat. Mit grenze = n
+// ist das Ergebnis ein maximaler Präfluss (Phase 1), mit grenze = 2n ein Fluss (Phase 2).
+// Ist puffer.einsortiert, geht es mit den Labels, Buckets und aktuellen Bögen im puffer
+// weiter, sonst werden die Labels zuerst per Breitensuche neu berechnet. Die Enden jedes
+// Bogens mit Push werden im puffer markiert.
+void Network::entlade_aktive_knoten(NodeId s, NodeId t, Reparaturzustand & zustand,
+                                    int grenze, double global_relabel_frequency){
+    int n = num_nodes();
+    ResidualNetwork & residual = zustand.residual;
+    std::vector<double> & excess_values = zustand.excess_values;
+    std::vector<int> & psi = zustand.psi;
+    Entladepuffer & puffer = zustand.puffer;
+    double toleranz = ueberschuss_toleranz(s, residual);
+    auto ist_aktiv = [&](NodeId v)
+    {
+        return excess_values[v]>toleranz && v != t && v != s && psi[v] < grenze; //activity of all nodes are significant except s and t.
+    };
+    LabelBuckets & aktive_knoten = puffer.aktive_knoten;  //active nodes, bucketed by psi
+    LabelBuckets & ebenen = puffer.ebenen;
+    std::vector<ResidualNetwork::ArcId> & aktueller_bogen = puffer.aktueller_bogen;
+    auto knoten_einsortieren = [&]()
+    {
+        aktive_knoten.clear();
+        ebenen.clear();
+        for (int i = 0; i < n; ++i) 
         {
-            aktive_knoten.push_back(i);
+            aktueller_bogen[i] = residual.first_arc(i);
+            if (psi[i] < n)
+            {
+                ebenen.insert(i, psi[i]);
+            }
+            if (ist_aktiv(i))
+            {
+                aktive_knoten.insert(i, psi[i]);
+            }
         }
+    };
+    auto labels_neu_berechnen = [&]()
+    {
+        labels_berechnen(s, t, zustand); //psi(s) = n
+        knoten_einsortieren();
+    };
+    if (!puffer.einsortiert)
+    {
+        labels_neu_berechnen();
     }
-    //3
+    double arbeit = 0; //Relabel-Arbeit seit der letzten Neuberechnung
+    double arbeit_grenze = global_relabel_frequency * (6.0*n + residual.num_arcs());
     while(!aktive_knoten.empty()){ //while still active nodes
         
-        NodeId cur = aktive_knoten.back(); //choose an active node (ideally with the biggest psi value.) 
-        for (int i = 0; i < aktive_knoten.size(); ++i)
+        NodeId cur = aktive_knoten.highest(); //choose an active node with the biggest psi value
+        ResidualNetwork::ArcId & bogen = aktueller_bogen[cur];
+        while (bogen < residual.first_arc(cur+1) && //check für zulässige Bögen im Residualgraphen.
+               !(residual.residual_capacity(bogen) > 0 && psi[cur] == psi[residual.head(bogen)]+1))
         {
-            if (psi[cur]<psi[aktive_knoten[i]])
+            ++bogen;
+        }
+        if (bogen < residual.first_arc(cur+1))   //we found a zulassige node
+        {
+            NodeId zulaessig = residual.head(bogen);
+            Flow::push(residual, bogen, excess_values); //push that zulassige node
+            puffer.markiere(cur);
+            puffer.markiere(zulaessig);
+            if (!ist_aktiv(cur))
+            {
+                aktive_knoten.remove(cur); //refresh activeness of cur
+            }
+
+            if (ist_aktiv(zulaessig) && !aktive_knoten.contains(zulaessig))
             {
-                cur = aktive_knoten[i];
+                aktive_knoten.insert(zulaessig, psi[zulaessig]); //after push, the pushed end can be activated, check for that
             }
+            continue;
         }
-        NodeId zulaessig = cur; //set zulaessig to itself. right now its not allowed. because psi(cur) != psi(cur)+1
-        for (auto n : residual->get_node(cur).adjacent_nodes()) //check für zulässige Knoten im Residualgraphen.
-        {   
-            if (psi[cur] == psi[n.id()]+1)  //if there is one
+        int alt = psi[cur];
+        aktive_knoten.remove(cur);
+        Flow::relabel(cur, psi, residual);   //if we couldnt find any relabel cur
+        bogen = residual.first_arc(cur);
+        arbeit += residual.first_arc(cur+1) - residual.first_arc(cur) + 12;
+        if (alt < n)
+        {
+            ebenen.remove(cur);
+            if (ebenen.first(alt) == -1) //Lücke: Knoten oberhalb von alt erreichen t nicht mehr
             {
-                zulaessig = n.id(); //add it to zulassig
+                for (int k = alt+1; k < n && k <= ebenen.max_label(); ++k)
+                {
+                    for (NodeId v = ebenen.first(k); v != -1; v = ebenen.first(k))
+                    {
+                        ebenen.remove(v);
+                        psi[v] = n;
+                        aktueller_bogen[v] = residual.first_arc(v);
+                        aktive_knoten.remove(v);
+                        if (ist_aktiv(v))
+                        {
+                            aktive_knoten.insert(v, n);
+                        }
+                    }
+                }
+                psi[cur] = std::max(psi[cur], n);
             }
         }
-        if (zulaessig != cur) //&& f->get_usage(cur,zulaessig)<f->residual_graph()->get_edge(cur,zulaessig).weight())   //if zulassig is not equal cur then we found a zulassige node
+        if (psi[cur] < n)
+        {
+            ebenen.insert(cur, psi[cur]);
+        }
+        if (ist_aktiv(cur))
         {
-            f->push(cur, zulaessig, residual, excess_values); //push that zulassige node
-            //if (f->get_excess(cur)==0)
-            if (excess_values[cur]==0)
+            aktive_knoten.insert(cur, psi[cur]); //cur moves to the bucket of its new label
+        }
+        if (global_relabel_frequency > 0 && arbeit > arbeit_grenze)
+        {
+            labels_neu_berechnen();
+            arbeit = 0;
+        }
+    }
+    puffer.einsortiert = true;
+}
+
+// Übernimmt den Fluss in f und hebt den Zustand für repair_flow dort auf.
+void Network::zustand_speichern(Flow * f, std::unique_ptr<Reparaturzustand> zustand){
+    f->set_usages(zustand->residual);
+    zustand->puffer.markierungen_loeschen();
+    zustand->version = version();
+    f->set_reparaturzustand(std::move(zustand));
+}
+
+Flow* Network::push_relabel(NodeId s, NodeId t, double global_relabel_frequency){
+    Flow* f = new Flow(this, s, t);
+    auto zustand = std::make_unique<Reparaturzustand>(*this);
+    ResidualNetwork & residual = zustand->residual;
+    saettige_quelle(s, residual, zustand->excess_values);
+    entlade_aktive_knoten(s, t, *zustand, num_nodes(), global_relabel_frequency);   //Phase 1
+    zustand->puffer.einsortiert = false;
+    entlade_aktive_knoten(s, t, *zustand, 2*num_nodes(), global_relabel_frequency); //Phase 2: Überschuss zurück zu s
+    zustand_speichern(f, std::move(zustand));
+    return f;
+}
+
+Flow* Network::parallel_push_relabel(NodeId s, NodeId t, int num_threads, double global_relabel_frequency){
+    Flow* f = new Flow(this, s, t);
+    auto zustand = std::make_unique<Reparaturzustand>(*this);
+    ResidualNetwork & residual = zustand->residual;
+    saettige_quelle(s, residual, zustand->excess_values);
+    parallele_phase_1(f, residual, zustand->excess_values, num_threads > 0 ? num_threads : default_num_threads(),
+                      global_relabel_frequency);
+    entlade_aktive_knoten(s, t, *zustand, 2*num_nodes(), global_relabel_frequency); //Phase 2: Überschuss zurück zu s
+    zustand_speichern(f, std::move(zustand));
+    return f;
+}
+
+double Network::min_cut(NodeId s, NodeId t, std::vector<NodeId> & source_side, double global_relabel_frequency){
+    Reparaturzustand zustand(*this);
+    return min_cut(s, t, source_side, zustand, global_relabel_frequency);
+}
+
+double Network::min_cut(NodeId s, NodeId t, std::vector<NodeId> & source_side, Reparaturzustand & zustand,
+                        double global_relabel_frequency){
+    if (zustand.residual.num_nodes() != num_nodes())
+    {
+        throw std::runtime_error("The state does not belong to this network.");
+    }
+    zustand.residual.clear_flow();
+    std::fill(zustand.excess_values.begin(), zustand.excess_values.end(), 0);
+    zustand.puffer.einsortiert = false;
+    saettige_quelle(s, zustand.residual, zustand.excess_values);
+    entlade_aktive_knoten(s, t, zustand, num_nodes(), global_relabel_frequency);
+    zustand.puffer.markierungen_loeschen();
+    //nach Phase 1 erreicht kein Knoten mit Überschuss mehr t; wer t nicht erreicht, liegt auf der Seite von s
+    labels_berechnen(s, t, zustand);
+    source_side.clear();
+    for (NodeId v = 0; v < num_nodes(); ++v)
+    {
+        if (zustand.psi[v] >= num_nodes())
+        {
+            source_side.push_back(v);
+        }
+    }
+    return zustand.excess_values[t];
+}
+
+void Network::repair_flow(Flow * f, const std::vector<CapacityChange> & changes, double global_relabel_frequency){
+    if (static_cast<EdgeId>(f->edge_flows().size()) > num_edge_ids())
+    {
+        throw std::runtime_error("The flow does not belong to this network.");
+    }
+    //erst prüfen, dann ändern; eine Kante darf mehrfach vorkommen
+    std::vector<double> neue_kapazitaet(changes.size());
+    for (size_t i = 0; i < changes.size(); ++i)
+    {
+        EdgeId e = changes[i].edge;
+        neue_kapazitaet[i] = get_node(edge_tail(e)).adjacent_nodes()[edge_position(e)].edge_weight();
+        for (size_t j = i; j-- > 0;)
+        {
+            if (changes[j].edge == e)
             {
-                auto iter = std::find(begin(aktive_knoten), end(aktive_knoten), cur);
-                aktive_knoten.erase(iter); //refresh activeness of cur
+                neue_kapazitaet[i] = neue_kapazitaet[j];
+                break;
             }
+        }
+        neue_kapazitaet[i] += changes[i].delta;
+        if (neue_kapazitaet[i] < 0)
+        {
+            throw std::runtime_error("Capacity change makes a capacity negative.");
+        }
+    }
+    NodeId n = num_nodes();
+    NodeId s = f->source();
+    NodeId t = f->sink();
+    Reparaturzustand * zustand = f->reparaturzustand();
+    //lokal geht es nur, wenn der aufgehobene Zustand noch zum Netzwerk passt
+    bool lokal = zustand != nullptr && zustand->version == version();
+    for (size_t i = 0; i < changes.size(); ++i)
+    {
+        set_edge_weight(changes[i].edge, neue_kapazitaet[i]);
+    }
+    if (lokal)
+    {
+        for (size_t i = 0; i < changes.size(); ++i)
+        {
+            zustand->residual.set_capacity(zustand->residual.arc_of_edge(changes[i].edge), neue_kapazitaet[i]);
+        }
+    }
+    else
+    {
+        //Zustand einmal aus edge_flows() neu aufbauen; der alte Fluss war bis auf Rundungsreste ausgeglichen
+        f->set_reparaturzustand(std::make_unique<Reparaturzustand>(*this));
+        zustand = f->reparaturzustand();
+        for (EdgeId e = 0; e < static_cast<EdgeId>(f->edge_flows().size()); ++e)
+        {
+            auto a = zustand->residual.arc_of_edge(e);
+            double fluss = f->edge_flows()[e];
+            if (a == -1 && fluss != 0)
+            {
+                throw std::runtime_error("An edge with flow was removed from the network.");
+            }
+            if (fluss != 0)
+            {
+                zustand->residual.push(a, fluss);
+            }
+        }
+    }
+    ResidualNetwork & residual = zustand->residual;
+    std::vector<double> & excess_values = zustand->excess_values;
+    std::vector<int> & psi = zustand->psi;
+    Entladepuffer & puffer = zustand->puffer;
+    //Bögen, deren Restkapazität wächst; an ihnen kann psi ungültig werden
+    std::vector<ResidualNetwork::ArcId> zu_pruefen;
+    //wo der alte Fluss die neue Kapazität übersteigt, entstehen Überschuss am Anfang und
+    //Defizit am Ende des Bogens
+    for (auto & change : changes)
+    {
+        auto a = residual.arc_of_edge(change.edge);
+        double zu_viel = -residual.residual_capacity(a);
+        if (zu_viel > 0)
+        {
+            NodeId anfang = residual.head(residual.reverse(a));
+            residual.push(a, -zu_viel);
+            excess_values[anfang] += zu_viel;
+            excess_values[residual.head(a)] -= zu_viel;
+            puffer.markiere(anfang);
+            puffer.markiere(residual.head(a));
+        }
+        else if (change.delta > 0)
+        {
+            zu_pruefen.push_back(a);
+        }
+    }
+    //Defizite abbauen: Fluss auf einem Weg aus Bögen mit positivem Fluss von v bis s, t oder
+    //einem Knoten mit Überschuss verringern. So ein Weg existiert, weil aus der Menge der
+    //von v so erreichbaren Knoten sonst mehr Fluss hinaus- als hineinginge.
+    double toleranz = ueberschuss_toleranz(s, residual);
+    std::vector<ResidualNetwork::ArcId> & vorgaenger = zustand->vorgaenger;
+    std::vector<NodeId> schlange;
+    for (auto & change : changes)
+    {
+        NodeId v = residual.head(residual.arc_of_edge(change.edge));
+        while (v != s && v != t && excess_values[v] < -toleranz)
+        {
+            NodeId ziel = invalid_node;
+            schlange.assign(1, v);
+            for (size_t i = 0; i < schlange.size() && ziel == invalid_node; ++i)
+            {
+                NodeId u = schlange[i];
+                for (auto a = residual.first_arc(u); a < residual.first_arc(u+1); ++a)
+                {
+                    NodeId w = residual.head(a);
+                    if (w != v && vorgaenger[w] == -1 && residual.flow(a) > 0)
+                    {
+                        vorgaenger[w] = a;
+                        schlange.push_back(w);
+                        if (w == s || w == t || excess_values[w] > 0)
+                        {
+                            ziel = w;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (ziel != invalid_node)
+            {
+                double menge = -excess_values[v];
+                if (ziel != s && ziel != t)
+                {
+                    menge = std::min(menge, excess_values[ziel]);
+                }
+                for (NodeId w = ziel; w != v; w = residual.head(residual.reverse(vorgaenger[w])))
+                {
+                    menge = std::min(menge, residual.flow(vorgaenger[w]));
+                }
+                for (NodeId w = ziel; w != v; w = residual.head(residual.reverse(vorgaenger[w])))
+                {
+                    residual.push(vorgaenger[w], -menge);
+                    zu_pruefen.push_back(vorgaenger[w]);
+                    puffer.markiere(w);
+                }
+                puffer.markiere(v);
+                excess_values[v] += menge;
+                excess_values[ziel] -= menge;
+            }
+            for (NodeId w : schlange)
+            {
+                vorgaenger[w] = -1;
+            }
+            if (ziel == invalid_node) //nur Rundungsreste
+            {
+                break;
+            }
+        }
+    }
+    //psi(x) <= psi(y)+1 für jeden Bogen x->y mit Restkapazität wiederherstellen, indem
+    //Labels nur gesenkt werden; das pflanzt sich rückwärts über Bögen mit Restkapazität
+    //fort. psi(s) = n bleibt, stattdessen sättigt s so einen Bogen. Verschiebt die Änderung
+    //den Schnitt weit, wird das wie in entlade_aktive_knoten abgebrochen und psi neu berechnet.
+    bool labels_gesenkt = lokal;
+    if (lokal)
+    {
+        auto pruefen = [&](ResidualNetwork::ArcId a)
+        {
+            NodeId x = residual.head(residual.reverse(a));
+            NodeId y = residual.head(a);
+            double rest = residual.residual_capacity(a);
+            if (rest <= 0)
+            {
+                return;
+            }
+            puffer.aktueller_bogen[x] = residual.first_arc(x); //a kann zulässig geworden sein
+            if (psi[x] <= psi[y]+1)
+            {
+                return;
+            }
+            if (x == s)
+            {
+                residual.push(a, rest);
+                excess_values[y] += rest;
+                excess_values[s] -= rest;
+                puffer.markiere(s);
+                puffer.markiere(y);
+            }
+            else
+            {
+                psi[x] = psi[y]+1;
+                schlange.push_back(x);
+            }
+        };
+        schlange.clear();
+        for (auto a : zu_pruefen)
+        {
+            pruefen(a);
+        }
+        double arbeit = 0;
+        double arbeit_grenze = global_relabel_frequency * (6.0*n + residual.num_arcs());
+        for (size_t i = 0; i < schlange.size() && labels_gesenkt; ++i)
+        {
+            NodeId x = schlange[i];
+            for (auto a = residual.first_arc(x); a < residual.first_arc(x+1); ++a)
+            {
+                pruefen(residual.reverse(a));
+            }
+            arbeit += residual.first_arc(x+1) - residual.first_arc(x) + 12;
+            labels_gesenkt = global_relabel_frequency <= 0 || arbeit <= arbeit_grenze;
+        }
+    }
+    if (labels_gesenkt)
+    {
+        for (NodeId x : schlange)
+        {
+            puffer.ebenen.remove(x);
+            if (psi[x] < n)
+            {
+                puffer.ebenen.insert(x, psi[x]);
+            }
+        }
+        //nach dem letzten Entladen war kein Knoten aktiv, aktiv werden nur markierte
+        for (NodeId v : puffer.geaendert)
+        {
+            if (excess_values[v] > toleranz && v != s && v != t && !puffer.aktive_knoten.contains(v))
+            {
+                puffer.aktive_knoten.insert(v, psi[v]);
+            }
+        }
+    }
+    else
+    {
+        //Defizitabbau kann neue s-t-Wege öffnen; erst wenn s alle Bögen sättigt, passt psi(s) = n
+        saettige_quelle(s, residual, excess_values);
+        puffer.markiere(s);
+        for (auto a = residual.first_arc(s); a < residual.first_arc(s+1); ++a)
+        {
+            puffer.markiere(residual.head(a));
+        }
+        puffer.einsortiert = false;
+    }
+    entlade_aktive_knoten(s, t, *zustand, 2*n, global_relabel_frequency);
+    if (lokal)
+    {
+        f->set_usages(residual, puffer.geaendert);
+    }
+    else
+    {
+        f->set_usages(residual);
+    }
+    puffer.markierungen_loeschen();
+    zustand->version = version();
+}
 
-            //if ((f->get_excess(zulaessig)>0)  && (zulaessig!=t)) //&& !(std::find(aktive_knoten.begin(),aktive_knoten.end(), zulaessig)==aktive_knoten.end()))
-            if ((excess_values[zulaessig]>0)  && (zulaessig!=t))
+Flow* Network::capacity_scaling(NodeId s, NodeId t){
+    Flow* f = new Flow(this, s, t);
+    auto zustand = std::make_unique<Reparaturzustand>(*this);
+    ResidualNetwork & residual = zustand->residual;
+    double max_kapazitaet = 0;
+    for (auto a = 0; a < residual.num_arcs(); ++a)
+    {
+        max_kapazitaet = std::max(max_kapazitaet, residual.capacity(a));
+    }
+    double delta = 0;
+    if (max_kapazitaet >= 1)
+    {
+        int exponent;
+        std::frexp(max_kapazitaet, &exponent); //max_kapazitaet = m * 2^exponent mit 0.5 <= m < 1
+        delta = std::ldexp(1.0, exponent-1);
+    }
+    std::vector<ResidualNetwork::ArcId> vorgaenger(num_nodes()); //Bogen, über den die Breitensuche einen Knoten erreicht
+    std::vector<NodeId> schlange;
+    auto weg_suchen = [&]() //Breitensuche von s nach t über Bögen mit Restkapazität >= delta
+    {
+        std::fill(vorgaenger.begin(), vorgaenger.end(), -1);
+        schlange.assign(1, s);
+        for (size_t i = 0; i < schlange.size(); ++i)
+        {
+            NodeId v = schlange[i];
+            for (auto a = residual.first_arc(v); a < residual.first_arc(v+1); ++a)
             {
-                aktive_knoten.push_back(zulaessig); //after push, the pushed end can be activated, check for that
+                NodeId w = residual.head(a);
+                double rest = residual.residual_capacity(a);
+                if (vorgaenger[w] == -1 && w != s && rest > 0 && rest >= delta)
+                {
+                    vorgaenger[w] = a;
+                    if (w == t)
+                    {
+                        return true;
+                    }
+                    schlange.push_back(w);
+                }
             }
-            sort( aktive_knoten.begin(), aktive_knoten.end());//kill duplicates in vector
-            aktive_knoten.erase( unique( aktive_knoten.begin(), aktive_knoten.end()), aktive_knoten.end() );
         }
-        else if (zulaessig == cur && cur != t) {
-            f->relabel(cur, psi, residual);   //if we couldnt find any relabel cur, dont relabel t.
+        return false;
+    };
+    while (true)
+    {
+        while (weg_suchen())
+        {
+            double engpass = residual.residual_capacity(vorgaenger[t]);
+            for (NodeId v = t; v != s; v = residual.head(residual.reverse(vorgaenger[v])))
+            {
+                engpass = std::min(engpass, residual.residual_capacity(vorgaenger[v]));
+            }
+            for (NodeId v = t; v != s; v = residual.head(residual.reverse(vorgaenger[v])))
+            {
+                residual.push(vorgaenger[v], engpass);
+            }
+        }
+        if (delta == 0)
+        {
+            break;
+        }
+        delta = delta > 1 ? delta/2 : 0;
+    }
+    //ohne Überschuss berechnet das nur Labels und Puffer für repair_flow
+    entlade_aktive_knoten(s, t, *zustand, 2*num_nodes(), 1.0);
+    zustand_speichern(f, std::move(zustand));
+    return f;
+}
+
+Flow* Network::dinic(NodeId s, NodeId t){
+    Flow* f = new Flow(this, s, t);
+    auto zustand = std::make_unique<Reparaturzustand>(*this);
+    ResidualNetwork & residual = zustand->residual;
+    std::vector<int> ebene(num_nodes());
+    std::vector<ResidualNetwork::ArcId> aktueller_bogen(num_nodes());
+    std::vector<NodeId> schlange;
+    auto niveaus_berechnen = [&]() //Breitensuche von s, true falls t erreichbar ist
+    {
+        std::fill(ebene.begin(), ebene.end(), -1);
+        ebene[s] = 0;
+        schlange.assign(1, s);
+        for (size_t i = 0; i < schlange.size() && ebene[t] == -1; ++i)
+        {
+            NodeId v = schlange[i];
+            for (auto a = residual.first_arc(v); a < residual.first_arc(v+1); ++a)
+            {
+                NodeId w = residual.head(a);
+                if (ebene[w] == -1 && residual.residual_capacity(a) > 0)
+                {
+                    ebene[w] = ebene[v]+1;
+                    schlange.push_back(w);
+                }
+            }
+        }
+        return ebene[t] != -1;
+    };
+    std::vector<ResidualNetwork::ArcId> weg; //Bögen von s zum aktuellen Knoten
+    while (niveaus_berechnen())
+    {
+        for (NodeId v = 0; v < num_nodes(); ++v)
+        {
+            aktueller_bogen[v] = residual.first_arc(v);
+        }
+        weg.clear();
+        NodeId v = s;
+        while (true)
+        {
+            if (v == t) //augmentieren und bis vor den ersten gesättigten Bogen zurückgehen
+            {
+                double engpass = residual.residual_capacity(weg[0]);
+                for (auto a : weg)
+                {
+                    engpass = std::min(engpass, residual.residual_capacity(a));
+                }
+                size_t erster_gesaettigt = weg.size();
+                for (size_t i = 0; i < weg.size(); ++i)
+                {
+                    residual.push(weg[i], engpass);
+                    if (erster_gesaettigt == weg.size() && residual.residual_capacity(weg[i]) <= 0)
+                    {
+                        erster_gesaettigt = i;
+                    }
+                }
+                weg.resize(erster_gesaettigt);
+                v = weg.empty() ? s : residual.head(weg.back());
+                continue;
+            }
+            ResidualNetwork::ArcId & bogen = aktueller_bogen[v];
+            while (bogen < residual.first_arc(v+1) &&
+                   !(residual.residual_capacity(bogen) > 0 && ebene[residual.head(bogen)] == ebene[v]+1))
+            {
+                ++bogen;
+            }
+            if (bogen < residual.first_arc(v+1))
+            {
+                weg.push_back(bogen);
+                v = residual.head(bogen);
+            }
+            else if (v == s) //Fluss ist blockierend
+            {
+                break;
+            }
+            else //Sackgasse: v nicht mehr betreten
+            {
+                weg.pop_back();
+                v = weg.empty() ? s : residual.head(weg.back());
+                ++aktueller_bogen[v];
+            }
         }
     }
-    delete residual;
+    //ohne Überschuss berechnet das nur Labels und Puffer für repair_flow
+    entlade_aktive_knoten(s, t, *zustand, 2*num_nodes(), 1.0);
+    zustand_speichern(f, std::move(zustand));
     return f;
 }
 
+Flow* Network::max_flow(NodeId s, NodeId t, MaxFlowEngine engine){
+    switch (engine)
+    {
+        case MaxFlowEngine::parallel_push_relabel:
+            return parallel_push_relabel(s, t);
+        case MaxFlowEngine::capacity_scaling:
+            return capacity_scaling(s, t);
+        case MaxFlowEngine::dinic:
+            return dinic(s, t);
+        default:
+            return push_relabel(s, t);
+    }
+}
+
+MaxFlowEngine parse_max_flow_engine(const std::string & name){
+    if (name == "push_relabel")
+    {
+        return MaxFlowEngine::push_relabel;
+    }
+    if (name == "parallel_push_relabel")
+    {
+        return MaxFlowEngine::parallel_push_relabel;
+    }
+    if (name == "capacity_scaling")
+    {
+        return MaxFlowEngine::capacity_scaling;
+    }
+    if (name == "dinic")
+    {
+        return MaxFlowEngine::dinic;
+    }
+    throw std::runtime_error("Unknown max-flow engine: " + name);
+}
+
 double Network::get_capacity(NodeId a, NodeId b){
     try{
-        double capacity = 0;
-        for (auto i : get_node(a).adjacent_nodes())
+        int position = find_neighbor(a, b);
+        if (position < 0)
         {
-            if (i.id()==b)
+            return 0;
+        }
+        const std::vector<Neighbor> & neighbors = get_node(a).adjacent_nodes();
+        if (num_parallel_edges(a, b) == 1)
+        {
+            return neighbors[position].edge_weight();
+        }
+        double capacity = 0; //parallele Kanten aufsummieren, ihre Reihenfolge ist beliebig
+        for (auto n : neighbors)
+        {
+            if (n.id()==b)
             {
-                capacity+=i.edge_weight();
+                capacity+=n.edge_weight();
             }
         }
         return capacity;
     }catch(...){}
     return 0;
 }
-Flow::Flow(Network* n, NodeId s, NodeId t): Graph(n->num_nodes(), Graph::DirType::directed), _network(n), _s(s), _t(t) {}
+Flow::Flow(Network* n, NodeId s, NodeId t): Graph(n->num_nodes(), Graph::DirType::directed), _network(n), _s(s), _t(t) {
+    enable_edge_index();
+}
 
 void Flow::set_usage(NodeId a, NodeId b, double u){
     Graph::Edge e(a,b,u); //add its flow.
@@ -149,6 +788,14 @@ double Flow::value(){
     return -get_excess(_s);
 }
 
+Graph::NodeId Flow::source() const{
+    return _s;
+}
+
+Graph::NodeId Flow::sink() const{
+    return _t;
+}
+
 double Flow::get_excess(Graph::NodeId a){
     double eingehender_fluss = 0;
     double ausgehender_fluss = 0;
@@ -168,7 +815,11 @@ double Flow::get_excess(Graph::NodeId a){
 }
 double Flow::get_usage(NodeId a, NodeId b){
         try{
-        double usage = 0;
+        if (num_parallel_edges(a, b) == 1)
+        {
+            return get_node(a).adjacent_nodes()[find_neighbor(a, b)].edge_weight();
+        }
+        double usage = 0; //bei parallelen Kanten zählt die zuletzt gesetzte
         for (auto i : get_node(a).adjacent_nodes())
         {
             if (i.id()==b)
@@ -182,22 +833,85 @@ double Flow::get_usage(NodeId a, NodeId b){
 }
 
 
-Graph* Flow::residual_graph(){
-    Graph* g = new Graph(num_nodes(), Graph::DirType::directed);
-    for(Graph::Edge e : _network->get_edges()){
-        double f_max = e.weight();
-        double f_use = get_usage(e.start(), e.end());
-        
-        if(f_use != 0){
-            Graph::Edge back(e.end(), e.start(), f_use);
-            g->add_edge(back);
+void Flow::set_usages(const ResidualNetwork & residual){
+    //ein früher gesetzter Fluss wird ersetzt, aber nur an Knoten, an deren ausgehenden Kanten
+    //er sich geändert hat; hat eine entfernte Kante noch Fluss, werden alle Knoten neu gesetzt
+    bool alle = false;
+    for (EdgeId e = 0; e < static_cast<EdgeId>(_edge_flows.size()); ++e)
+    {
+        alle = alle || (_edge_flows[e] != 0 && residual.arc_of_edge(e) == -1);
+    }
+    _edge_flows.resize(_network->num_edge_ids(), 0);
+    for (NodeId a = 0; a < num_nodes(); ++a)
+    {
+        if (fluss_uebernehmen(a, residual) || alle)
+        {
+            nutzung_neu_setzen(a);
+        }
+    }
+}
+
+void Flow::set_usages(const ResidualNetwork & residual, const std::vector<NodeId> & knoten){
+    //das Netzwerk hat seit dem letzten Aufruf keine Kanten verloren
+    _edge_flows.resize(_network->num_edge_ids(), 0);
+    for (NodeId a : knoten)
+    {
+        if (fluss_uebernehmen(a, residual))
+        {
+            nutzung_neu_setzen(a);
+        }
+    }
+}
+
+//true, falls sich der Fluss einer Kante ab a geändert hat
+bool Flow::fluss_uebernehmen(NodeId a, const ResidualNetwork & residual){
+    bool geaendert = false;
+    for (auto n : _network->get_node(a).adjacent_nodes())
+    {
+        double fluss = residual.flow(residual.arc_of_edge(n.edge_id()));
+        geaendert = geaendert || fluss != _edge_flows[n.edge_id()];
+        _edge_flows[n.edge_id()] = fluss;
+    }
+    return geaendert;
+}
+
+void Flow::nutzung_neu_setzen(NodeId a){
+    //die Kanten ab a werden an Ort und Stelle überschrieben; ohne Fluss bleiben sie mit 0 stehen,
+    //so verbrauchen wiederholte Reparaturen keine neuen Kanten-Ids
+    for (auto n : get_node(a).adjacent_nodes())
+    {
+        set_edge_weight(n.edge_id(), 0);
+    }
+    //parallele Kanten a->b werden zu einer Kante mit der Summe ihrer Flüsse
+    for (auto n : _network->get_node(a).adjacent_nodes())
+    {
+        double fluss = _edge_flows[n.edge_id()];
+        if (fluss == 0)
+        {
+            continue;
         }
-        if(f_max > f_use){
-            Edge remaining(e.start(), e.end(), f_max - f_use);
-            g->add_edge(remaining);
+        EdgeId e = find_edge(a, n.id());
+        if (e == invalid_edge)
+        {
+            set_usage(a, n.id(), fluss);
+        }
+        else
+        {
+            set_edge_weight(e, get_node(a).adjacent_nodes()[edge_position(e)].edge_weight() + fluss);
         }
     }
-    return g;
+}
+
+const std::vector<double> & Flow::edge_flows() const{
+    return _edge_flows;
+}
+
+Reparaturzustand * Flow::reparaturzustand(){
+    return _reparaturzustand.get();
+}
+
+void Flow::set_reparaturzustand(std::unique_ptr<Reparaturzustand> zustand){
+    _reparaturzustand = std::move(zustand);
 }
 
 void Flow::print(){
@@ -213,5 +927,9 @@ void Flow::print(){
 
 std::vector<Graph::Edge> Flow::get_edges(){
     // Ermöglicht Zugriff auf die Kanten des zugrundeliegenden Graphen. Auf die anderen Graphen-Funktionen kann nicht zugegriffen werden.
-    return Graph::get_edges();
+    // Kanten, deren Fluss bei einer Reparatur auf 0 gefallen ist, werden ausgelassen.
+    std::vector<Edge> kanten = Graph::get_edges();
+    kanten.erase(std::remove_if(kanten.begin(), kanten.end(), [](const Edge & e) { return e.weight() == 0; }),
+                 kanten.end());
+    return kanten;
 }
@@ -2,31 +2,133 @@
 #ifndef FLOW_H
 #define FLOW_H
 
+#include <memory>
+#include <string>
 #include <vector>
 #include "graph.h" 
+#include "csr_graph.h"
+#include "residual_network.h"
+#include "label_buckets.h"
 
 class Flow;
 
+enum class MaxFlowEngine {push_relabel, parallel_push_relabel, capacity_scaling, dinic};
+// "push_relabel", "parallel_push_relabel", "capacity_scaling" oder "dinic"
+MaxFlowEngine parse_max_flow_engine(const std::string & name);
+
+struct CapacityChange {
+    Graph::EdgeId edge;
+    double delta;   //neue Kapazität = alte Kapazität + delta, darf nicht negativ werden
+};
+
+//Hilfsstrukturen von entlade_aktive_knoten; sie überleben einen Aufruf, damit der nächste
+//(etwa in repair_flow) nicht alle Knoten neu einsortieren muss
+struct Entladepuffer {
+    Entladepuffer(Graph::NodeId n);
+    void markiere(Graph::NodeId v);   //der Fluss auf einem Bogen von v hat sich geändert
+    void markierungen_loeschen();
+
+    LabelBuckets aktive_knoten;       //aktive Knoten nach psi
+    LabelBuckets ebenen;              //alle Knoten mit psi < n, für die Lückenheuristik
+    std::vector<ResidualNetwork::ArcId> aktueller_bogen; //davor liegen keine zulässigen Bögen
+    bool einsortiert = false;         //die drei passen zu den Labels und zum Überschuss
+    std::vector<Graph::NodeId> geaendert;   //markierte Knoten
+    std::vector<bool> ist_geaendert;
+    std::vector<bool> besucht;        //für die Breitensuche von labels_berechnen
+    std::vector<Graph::NodeId> schlange;
+};
+
+//Was repair_flow von einer Berechnung zur nächsten aufhebt: den Residualgraphen mit dem
+//Fluss, den Überschuss (bis auf Rundungsreste 0), die Labels und die Puffer; O(n + m)
+//Speicher. min_cut benutzt denselben Zustand für viele Schnitte hintereinander.
+struct Reparaturzustand {
+    Reparaturzustand(const Graph & network);
+
+    ResidualNetwork residual;
+    std::vector<double> excess_values;
+    std::vector<int> psi;             //gültige Labels für residual
+    Entladepuffer puffer;
+    std::vector<ResidualNetwork::ArcId> vorgaenger;  //für den Defizitabbau, sonst überall -1
+    unsigned long version;            //Graph::version() des Netzwerks, zu der residual passt
+};
+
 class Network : public Graph {
     public:
             Network(NodeId num_nodes);
             Network(const char* filename);
+            Network(const CsrGraph & g);
             void set_capacity(NodeId a, NodeId b, double c);
             double get_capacity(NodeId a, NodeId b);
-            Flow* push_relabel(NodeId s, NodeId t);
+            // Alle global_relabel_frequency * (6n + m) Einheiten Relabel-Arbeit werden
+            // die Labels per Breitensuche neu berechnet, 0 schaltet das ab.
+            Flow* push_relabel(NodeId s, NodeId t, double global_relabel_frequency = 1.0);
+            // Phase 1 in synchronen Runden auf num_threads Threads (0: so viele, wie die
+            // Hardware hat): alle aktiven Knoten werden gleichzeitig mit den Labels vom
+            // Rundenbeginn entladen, danach gleichzeitig relabelt. Die Labels werden
+            // per paralleler Breitensuche neu berechnet; Phase 2 läuft sequentiell.
+            Flow* parallel_push_relabel(NodeId s, NodeId t, int num_threads = 0,
+                                        double global_relabel_frequency = 1.0);
+            // Nur Phase 1 von push_relabel: gibt den Wert eines minimalen s-t-Schnitts
+            // zurück, source_side enthält die Knoten auf der Seite von s.
+            double min_cut(NodeId s, NodeId t, std::vector<NodeId> & source_side,
+                           double global_relabel_frequency = 1.0);
+            // Dasselbe mit einem Zustand für dieses Netzwerk, dessen Fluss, Überschuss und
+            // Puffer zuerst zurückgesetzt werden; so lassen sich viele Schnitte ohne neue
+            // Allokation berechnen. Ändert das Netzwerk nicht, mehrere Threads dürfen es mit
+            // je eigenem zustand aufrufen.
+            double min_cut(NodeId s, NodeId t, std::vector<NodeId> & source_side,
+                           Reparaturzustand & zustand, double global_relabel_frequency = 1.0);
+            // Augmentiert entlang kürzester Wege im Delta-Residualgraphen (nur Bögen mit
+            // Restkapazität >= Delta), Delta halbiert sich von der größten Zweierpotenz
+            // <= maximale Kapazität bis 1; eine letzte Phase mit Delta = 0 erledigt
+            // nicht ganzzahlige Reste.
+            Flow* capacity_scaling(NodeId s, NodeId t);
+            // Blockierende Flüsse im Niveaugraphen der Breitensuche, gefunden per
+            // Tiefensuche mit aktuellem Bogen pro Knoten.
+            Flow* dinic(NodeId s, NodeId t);
+            Flow* max_flow(NodeId s, NodeId t, MaxFlowEngine engine);
+            // Ändert die Kapazitäten und macht f (von einer der Methoden oben für dieses
+            // Netzwerk berechnet) wieder zu einem maximalen Fluss. Wo der alte Fluss die neue
+            // Kapazität übersteigt, entstehen Überschuss am Anfang und Defizit am Ende des
+            // Bogens; Defizite werden entlang von Flusswegen abgebaut, der Überschuss wird
+            // wie in push_relabel entladen. f hebt dafür Residualgraph, Labels und Puffer auf:
+            // nur die Bögen der geänderten Kanten bekommen neue Kapazitäten, Labels werden nur
+            // dort gesenkt, wo Bögen Restkapazität bekommen, und nur Knoten, die dabei aktiv
+            // werden, werden entladen; nichts davon läuft über das ganze Netz.
+            // Wurde das Netzwerk seit der Berechnung von f anders als mit repair_flow geändert
+            // (Graph::version()), wird der Zustand einmal in O(n + m) aus edge_flows() neu
+            // aufgebaut. Kanten dürfen dabei hinzugekommen sein; entfernt werden dürfen nur
+            // solche ohne Fluss.
+            void repair_flow(Flow * f, const std::vector<CapacityChange> & changes,
+                             double global_relabel_frequency = 1.0);
 
     private:
+            void entlade_aktive_knoten(NodeId s, NodeId t, Reparaturzustand & zustand,
+                                       int grenze, double global_relabel_frequency);
+            void labels_berechnen(NodeId s, NodeId t, Reparaturzustand & zustand);
+            void zustand_speichern(Flow * f, std::unique_ptr<Reparaturzustand> zustand);
+            double ueberschuss_toleranz(NodeId s, const ResidualNetwork & residual);
+            void parallele_phase_1(Flow * f, ResidualNetwork & residual,
+                                   std::vector<double> & excess_values, int num_threads,
+                                   double global_relabel_frequency);
+            void saettige_quelle(NodeId s, ResidualNetwork & residual, std::vector<double> & excess_values);
 };
 class Flow : private Graph {
     public:
         Flow(Network* n, NodeId s, NodeId t);
         void set_usage(NodeId a, NodeId b, double u);
         double get_usage(NodeId a, NodeId b);
-        Graph* residual_graph();
+        void set_usages(const ResidualNetwork & residual); //übernimmt den Fluss aller Bögen
+        void set_usages(const ResidualNetwork & residual, const std::vector<NodeId> & knoten); //nur der Bögen, die in knoten beginnen
+        const std::vector<double> & edge_flows() const;    //nach Graph::EdgeId des Netzwerks
+        Reparaturzustand * reparaturzustand();   //für repair_flow, nullptr falls keiner aufgehoben wurde
+        void set_reparaturzustand(std::unique_ptr<Reparaturzustand> zustand);
         double value();
+        NodeId source() const;
+        NodeId sink() const;
         void print();
-        void push(NodeId s, NodeId t, Graph * residual, std::vector<double> & excess_values);
-        void relabel(NodeId v, std::vector<int> &psi, Graph * residual);
+        static void push(ResidualNetwork & residual, ResidualNetwork::ArcId a, std::vector<double> & excess_values);
+        static void relabel(NodeId v, std::vector<int> &psi, const ResidualNetwork & residual);
         double get_excess(Graph::NodeId a);
         double get_excess_with_print(Graph::NodeId a);
         double eingehender_fluss(Graph::NodeId a);
@@ -36,5 +138,9 @@ class Flow : private Graph {
         Network* _network;
         NodeId _s;
         NodeId _t;
+        std::vector<double> _edge_flows;
+        std::unique_ptr<Reparaturzustand> _reparaturzustand;
+        bool fluss_uebernehmen(NodeId a, const ResidualNetwork & residual);
+        void nutzung_neu_setzen(NodeId a);
 };
 #endif
@@ -0,0 +1,101 @@
+// gomory_hu_tree.cpp (Implementation of Class GomoryHuTree)
+
+#include <algorithm>
+#include "gomory_hu_tree.h"
+#include "flow.h"
+#include "parallel.h"
+
+GomoryHuTree::GomoryHuTree(const Graph & network, int num_threads):
+  _parent(network.num_nodes(), 0), _cut(network.num_nodes(), Graph::infinite_weight),
+  _depth(network.num_nodes(), -1)
+{
+   NodeId n = network.num_nodes();
+   if (n == 0) {
+        return;
+   }
+   Network symmetric(n);
+   for (NodeId v = 0; v < n; ++v) {
+        for (auto neighbor: network.get_node(v).adjacent_nodes()) {
+            symmetric.add_edge(v, neighbor.id(), neighbor.edge_weight());
+            if (network.dirtype == Graph::directed) {
+                symmetric.add_edge(neighbor.id(), v, neighbor.edge_weight());
+            }
+        }
+   }
+   _parent[0] = Graph::invalid_node;
+
+   // Gusfield: the cut for s only depends on parent(s), which only earlier
+   // iterations change. So a batch s,...,s+k-1 is cut in parallel with the
+   // current parents, and the results are applied in order until the first
+   // one whose parent has changed in the meantime; that one starts the next
+   // batch. The first cut of a batch is always valid.
+   int batch_size = std::min<int>(num_threads > 0 ? num_threads : default_num_threads(), n - 1);
+   std::vector<Reparaturzustand> states;
+   states.reserve(batch_size);
+   for (int i = 0; i < batch_size; ++i) {
+        states.emplace_back(symmetric);
+   }
+   std::vector<NodeId> sink(batch_size);
+   std::vector<double> value(batch_size);
+   std::vector<std::vector<NodeId>> source_side(batch_size);
+   std::vector<bool> on_source_side(n, false);
+   NodeId s = 1;
+   while (s < n) {
+        int size = std::min<int>(batch_size, n - s);
+        for (int i = 0; i < size; ++i) {
+            sink[i] = _parent[s + i];
+        }
+        parallel_for(size, [&](int i) {
+            value[i] = symmetric.min_cut(s + i, sink[i], source_side[i], states[i]);
+        });
+        for (int i = 0; i < size and _parent[s] == sink[i]; ++i, ++s) {
+            NodeId t = sink[i];
+            for (NodeId v: source_side[i]) {
+                on_source_side[v] = true;
+            }
+            _cut[s] = value[i];
+            for (NodeId v: source_side[i]) {
+                if (v != s and _parent[v] == t) {
+                    _parent[v] = s;
+                }
+            }
+            if (_parent[t] != Graph::invalid_node and on_source_side[_parent[t]]) {
+                _parent[s] = _parent[t];
+                _parent[t] = s;
+                _cut[s] = _cut[t];
+                _cut[t] = value[i];
+            }
+            for (NodeId v: source_side[i]) {
+                on_source_side[v] = false;
+            }
+        }
+   }
+
+   // depths, following each parent path only up to the first known depth
+   _depth[0] = 0;
+   std::vector<NodeId> path;
+   for (NodeId v = 0; v < n; ++v) {
+        NodeId u = v;
+        while (_depth[u] == -1) {
+            path.push_back(u);
+            u = _parent[u];
+        }
+        int depth = _depth[u];
+        for (; not path.empty(); path.pop_back()) {
+            _depth[path.back()] = ++depth;
+        }
+   }
+}
+
+double GomoryHuTree::min_cut(NodeId u, NodeId v) const
+{
+   double cut = Graph::infinite_weight;
+   while (u != v) {
+        if (_depth[u] < _depth[v]) {
+            std::swap(u, v);
+        }
+        cut = std::min(cut, _cut[u]);
+        u = _parent[u];
+   }
+   return cut;
+}
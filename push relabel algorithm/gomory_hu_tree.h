@@ -0,0 +1,37 @@
+// gomory_hu_tree.h (Declaration of Class GomoryHuTree)
+#ifndef GOMORY_HU_TREE_H
+#define GOMORY_HU_TREE_H
+
+#include <vector>
+#include "graph.h"
+
+// Gomory-Hu tree of an undirected network, built with Gusfield's algorithm
+// from n-1 minimum cuts of the network itself (no contractions). For all
+// vertices u != v, the minimum u-v cut value equals the smallest cut value on
+// the tree path between u and v, and the tree edge that attains it induces a
+// minimum u-v cut.
+class GomoryHuTree {
+public:
+  using NodeId = Graph::NodeId;
+
+  // Every arc a->b of network is an undirected edge of capacity its weight;
+  // in an undirected Graph both halves of an edge count once. The cuts are
+  // computed speculatively in batches on num_threads threads (0: as many as
+  // the hardware has), each thread reusing its own min_cut state.
+  GomoryHuTree(const Graph & network, int num_threads = 0);
+
+  NodeId num_nodes() const { return _parent.size(); }
+  NodeId root() const { return 0; }
+  NodeId parent(NodeId v) const { return _parent[v]; }      // Graph::invalid_node for the root
+  double parent_cut(NodeId v) const { return _cut[v]; }    // minimum v-parent(v) cut value
+
+  // minimum u-v cut value in O(n); Graph::infinite_weight if u == v
+  double min_cut(NodeId u, NodeId v) const;
+
+private:
+  std::vector<NodeId> _parent;
+  std::vector<double> _cut;
+  std::vector<int> _depth;
+};
+
+#endif // GOMORY_HU_TREE_H
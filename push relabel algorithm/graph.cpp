@@ -1,22 +1,27 @@
 // graph.cpp (Implementation of Class Graph)
 
-#include <fstream>
-#include <sstream>
 #include <stdexcept>
 #include <limits>
+#include <algorithm>
+#include <fstream>
 #include "graph.h"
+#include "graph_reader.h"
+#include "csr_graph.h"
+#include "parallel.h"
 #include <iostream>
 
 const Graph::NodeId Graph::invalid_node = -1;
+const Graph::EdgeId Graph::invalid_edge = -1;
 const double Graph::infinite_weight = std::numeric_limits<double>::max();
 
 
 void Graph::add_nodes(NodeId num_new_nodes)
 {
    _nodes.resize(num_nodes() + num_new_nodes);
+   ++_version;
 }
 //neighbor constructor
-Graph::Neighbor::Neighbor(Graph::NodeId n, double w): _id(n), _edge_weight(w) {}
+Graph::Neighbor::Neighbor(Graph::NodeId n, double w, Graph::EdgeId e): _id(n), _edge_weight(w), _edge_id(e) {}
 
 //edge constructors
 Graph::Edge::Edge(Graph::NodeId a, Graph::NodeId b, double c, Graph::DirType d):
@@ -51,45 +56,216 @@ Graph::Graph(NodeId num, DirType dtype): dirtype(dtype) {
     _nodes.resize(num);
 }
 
-void Graph::add_edge(Graph::Edge e){
-    add_edge(e.start(), e.end(), e.weight());
+Graph::EdgeId Graph::add_edge(Graph::Edge e){
+    return add_edge(e.start(), e.end(), e.weight());
 }
 
-void Graph::add_edge(NodeId tail, NodeId head, double weight)
+Graph::EdgeId Graph::add_edge(NodeId tail, NodeId head, double weight)
 {
    if (tail >= num_nodes() or tail < 0 or head >= num_nodes() or head < 0) {
        throw std::runtime_error("Edge cannot be added due to undefined endpoint.");
    }
-   _nodes[tail].add_neighbor(head, weight);
+   EdgeId e = new_arc(tail, head, weight);
    if (dirtype == Graph::undirected) {
-        _nodes[head].add_neighbor(tail, weight);
+        EdgeId r = new_arc(head, tail, weight);
+        _reverse_edge[e] = r;
+        _reverse_edge[r] = e;
+   }
+   return e;
+}
+
+Graph::EdgeId Graph::new_arc(NodeId tail, NodeId head, double weight)
+{
+   EdgeId e = _edge_tail.size();
+   ++_version;
+   _edge_tail.push_back(tail);
+   _edge_position.push_back(_nodes[tail].adjacent_nodes().size());
+   _reverse_edge.push_back(invalid_edge);
+   _nodes[tail].add_neighbor(head, weight, e);
+   if (_use_edge_index) {
+        _next_parallel.push_back(e);
+        _prev_parallel.push_back(e);
+        link_parallel(e, tail, head);
    }
+   return e;
 }
 
+void Graph::link_parallel(EdgeId e, NodeId tail, NodeId head)
+{
+   EdgeId first = _edge_index.edge(tail, head);
+   _edge_index.insert(tail, head, e);
+   if (first != invalid_edge) {       // e becomes the last arc of the list
+        EdgeId last = _prev_parallel[first];
+        _next_parallel[last] = e;
+        _prev_parallel[e] = last;
+        _next_parallel[e] = first;
+        _prev_parallel[first] = e;
+   }
+}
 
-void Graph::Node::add_neighbor(Graph::NodeId nodeid, double weight)
+
+void Graph::Node::add_neighbor(Graph::NodeId nodeid, double weight, Graph::EdgeId edge_id)
 {
-   _neighbors.push_back(Graph::Neighbor(nodeid, weight));
+   _neighbors.push_back(Graph::Neighbor(nodeid, weight, edge_id));
 }
 
 void Graph::remove_edge(NodeId tail, NodeId head){
  if (tail >= num_nodes() or tail < 0 or head >= num_nodes() or head < 0) {
        throw std::runtime_error("Edge cannot be removed due to undefined endpoint.");
    }
-   _nodes[tail].remove_neighbor(head);
-   /*if (dirtype == Graph::undirected) {
-        _nodes[head].remove_neighbor(tail);
+   EdgeId e = find_edge(tail, head);
+   if (e != invalid_edge) {
+        remove_edge(e);
+   }
+}
+
+void Graph::remove_edge(EdgeId e){
+   check_edge(e);
+   /*if (dirtype == Graph::undirected and _reverse_edge[e] != invalid_edge) {
+        remove_arc(_reverse_edge[e]);
    }*/
-    
+   remove_arc(e);
 }
 
-Graph::Neighbor Graph::get_neighbor(Graph::NodeId a, Graph::NodeId b){
-    for(Graph::Neighbor n : get_node(a).adjacent_nodes()){
-        if(n.id() == b){
-            return n;
+void Graph::remove_arc(EdgeId e){
+   NodeId tail = _edge_tail[e];
+   int position = _edge_position[e];
+   if (_use_edge_index) {
+        NodeId head = _nodes[tail].adjacent_nodes()[position].id();
+        if (_edge_index.edge(tail, head) == e) {
+            _edge_index.set_edge(tail, head, _next_parallel[e]);
+        }
+        _edge_index.erase(tail, head);
+        _next_parallel[_prev_parallel[e]] = _next_parallel[e];
+        _prev_parallel[_next_parallel[e]] = _prev_parallel[e];
+        _next_parallel[e] = _prev_parallel[e] = e;
+   }
+   // the last arc of the tail takes the free position
+   EdgeId moved = _nodes[tail].remove_neighbor_at(position);
+   if (moved != invalid_edge) {
+        _edge_position[moved] = position;
+   }
+   _edge_position[e] = -1;
+   ++_version;
+   if (_reverse_edge[e] != invalid_edge) {
+        _reverse_edge[_reverse_edge[e]] = invalid_edge;
+        _reverse_edge[e] = invalid_edge;
+   }
+}
+
+void Graph::check_edge(EdgeId e) const {
+    if (e < 0 or e >= num_edge_ids() or _edge_position[e] < 0) {
+        throw std::runtime_error("Invalid edge id.");
+    }
+}
+
+Graph::EdgeId Graph::find_edge(Graph::NodeId a, Graph::NodeId b) const {
+    const std::vector<Neighbor> & neighbors = get_node(a).adjacent_nodes();
+    if (_use_edge_index) {
+        return _edge_index.edge(a, b);
+    }
+    for (Graph::Neighbor n : neighbors) {
+        if (n.id() == b) {
+            return n.edge_id();
+        }
+    }
+    return invalid_edge;
+}
+
+int Graph::find_neighbor(Graph::NodeId a, Graph::NodeId b) const {
+    EdgeId e = find_edge(a, b);
+    return e == invalid_edge ? -1 : _edge_position[e];
+}
+
+Graph::NodeId Graph::edge_tail(EdgeId e) const {
+    check_edge(e);
+    return _edge_tail[e];
+}
+
+Graph::NodeId Graph::edge_head(EdgeId e) const {
+    check_edge(e);
+    return _nodes[_edge_tail[e]].adjacent_nodes()[_edge_position[e]].id();
+}
+
+int Graph::edge_position(EdgeId e) const {
+    check_edge(e);
+    return _edge_position[e];
+}
+
+Graph::EdgeId Graph::reverse_edge(EdgeId e) const {
+    check_edge(e);
+    return _reverse_edge[e];
+}
+
+void Graph::set_edge_weight(EdgeId e, double weight) {
+    check_edge(e);
+    _nodes[_edge_tail[e]].set_weight_at(_edge_position[e], weight);
+    ++_version;
+    if (_reverse_edge[e] != invalid_edge) {
+        _nodes[_edge_tail[_reverse_edge[e]]].set_weight_at(_edge_position[_reverse_edge[e]], weight);
+    }
+}
+
+Graph::EdgeId Graph::num_edge_ids() const {
+    return _edge_tail.size();
+}
+
+unsigned long Graph::version() const {
+    return _version;
+}
+
+int Graph::num_parallel_edges(Graph::NodeId a, Graph::NodeId b) const {
+    if (_use_edge_index) {
+        get_node(a);                       // validates a
+        return _edge_index.count(a, b);
+    }
+    int count = 0;
+    for (Graph::Neighbor n : get_node(a).adjacent_nodes()) {
+        if (n.id() == b) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void Graph::enable_edge_index(){
+    _edge_index.clear();
+    _next_parallel.resize(num_edge_ids());
+    _prev_parallel.resize(num_edge_ids());
+    for (NodeId i = 0; i < num_nodes(); ++i) {
+        for (Graph::Neighbor n : _nodes[i].adjacent_nodes()) {
+            _next_parallel[n.edge_id()] = _prev_parallel[n.edge_id()] = n.edge_id();
+            link_parallel(n.edge_id(), i, n.id());
         }
     }
-    throw std::runtime_error("No such edge!");
+    _use_edge_index = true;
+}
+
+void Graph::disable_edge_index(){
+    _edge_index.clear();
+    _next_parallel = std::vector<EdgeId>();
+    _prev_parallel = std::vector<EdgeId>();
+    _use_edge_index = false;
+}
+
+bool Graph::has_edge_index() const {
+    return _use_edge_index;
+}
+
+std::size_t Graph::edge_index_memory() const {
+    if (not _use_edge_index) {
+        return 0;
+    }
+    return _edge_index.memory_usage()
+           + (_next_parallel.capacity() + _prev_parallel.capacity()) * sizeof(EdgeId);
+}
+
+Graph::Neighbor Graph::get_neighbor(Graph::NodeId a, Graph::NodeId b){
+    int position = find_neighbor(a, b);
+    if (position < 0) {
+        throw std::runtime_error("No such edge!");
+    }
+    return get_node(a).adjacent_nodes()[position];
 }
 Graph::Edge Graph::get_edge(Graph::NodeId a, Graph::NodeId b){
     Graph::Neighbor n = get_neighbor(a,b);
@@ -111,14 +287,24 @@ std::vector<Graph::Edge> Graph::get_edges(){
     return edges;
 }
 
-void Graph::Node::remove_neighbor(Graph::NodeId nodeid){
+void Graph::Node::reserve(int num_neighbors)
+{
+   _neighbors.reserve(num_neighbors);
+}
+
+Graph::EdgeId Graph::Node::remove_neighbor_at(int position)
+{
+   _neighbors[position] = _neighbors.back();
+   _neighbors.pop_back();
+   if (position == static_cast<int>(_neighbors.size())) {
+        return Graph::invalid_edge;
+   }
+   return _neighbors[position].edge_id();
+}
 
-    _neighbors.erase(
-        std::remove_if(_neighbors.begin(), _neighbors.end(),
-                       [nodeid](Graph::Neighbor n)
-                       {
-                           return n.id() == nodeid;
-                       }));
+void Graph::Node::set_weight_at(int position, double weight)
+{
+   _neighbors[position] = Graph::Neighbor(_neighbors[position].id(), weight, _neighbors[position].edge_id());
 }
 const std::vector<double> Graph::Node::data() const
 {
@@ -158,6 +344,11 @@ double Graph::Neighbor::edge_weight() const
    return _edge_weight;
 }
 
+Graph::EdgeId Graph::Neighbor::edge_id() const
+{
+   return _edge_id;
+}
+
 void Graph::print() const
 {
    if (dirtype == Graph::directed) {
@@ -200,74 +391,111 @@ Graph Graph::transform_edge_weights( double (*transform)(double)){
 }
 
 
-void Graph::read_from_file(char const * filename, DirType dtype){
-   std::ifstream file(filename);                             // open file
-   if (not file) {
-        throw std::runtime_error("Cannot open file.");
+void Graph::add_edge_list(const EdgeList & edges){
+   // every adjacency list is allocated once with its final size
+   NodeId first_new = num_nodes();
+   add_nodes(edges.num_nodes);
+   std::vector<int> degree = edges.degrees(dirtype);
+   for (NodeId i = 0; i < edges.num_nodes; ++i) {
+        _nodes[first_new + i].reserve(_nodes[first_new + i].adjacent_nodes().size() + degree[i]);
    }
-
-   Graph::NodeId num = 0;
-   std::string line;
-   std::getline(file, line);                 // get first line of file
-   std::stringstream ss(line);               // convert line to a stringstream
-   ss >> num;                                // for which we can use >>
-   if (not ss) {
-        throw std::runtime_error("Invalid file format.");
+   int num_arcs = dirtype == Graph::undirected ? 2 * edges.num_edges() : edges.num_edges();
+   _edge_tail.reserve(num_edge_ids() + num_arcs);
+   _edge_position.reserve(num_edge_ids() + num_arcs);
+   _reverse_edge.reserve(num_edge_ids() + num_arcs);
+   for (int i = 0; i < edges.num_edges(); ++i) {
+        EdgeId e = new_arc(first_new + edges.tails[i], first_new + edges.heads[i], edges.weights[i]);
+        if (dirtype == Graph::undirected) {
+            EdgeId r = new_arc(first_new + edges.heads[i], first_new + edges.tails[i], edges.weights[i]);
+            _reverse_edge[e] = r;
+            _reverse_edge[r] = e;
+        }
    }
-   add_nodes(num);
-
-   int linenum = 0;
-   while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        Graph::NodeId head, tail;
-        ss >> tail >> head;
-        if (not ss) {
-            throw std::runtime_error("Invalid file format at line " + std::to_string(linenum));
+}
+
+void Graph::add_csr_graph(const CsrGraph & g, const std::vector<EdgeId> * input_order){
+   // g has the same dirtype, so undirected edges are already mirrored
+   NodeId first_new = num_nodes();
+   EdgeId first_id = num_edge_ids();
+   auto id = [first_id, input_order](CsrGraph::EdgeId e) {
+        return first_id + (input_order ? (*input_order)[e] : e);
+   };
+   add_nodes(g.num_nodes());
+   _edge_tail.resize(first_id + g.num_edges());
+   _edge_position.resize(first_id + g.num_edges());
+   _reverse_edge.resize(first_id + g.num_edges(), invalid_edge);
+   int num_parts = g.num_edges() < (1 << 20) ? 1 : default_num_threads();
+   parallel_for(num_parts, [&](int part) {
+        for (NodeId i = part_begin(g.num_nodes(), num_parts, part);
+             i < part_begin(g.num_nodes(), num_parts, part + 1); ++i)
+        {
+            _nodes[first_new + i].reserve(g.adjacent_nodes(i).size());
+            for (CsrGraph::EdgeId e = g.first_edge(i); e < g.first_edge(i + 1); ++e) {
+                _edge_tail[id(e)] = first_new + i;
+                _edge_position[id(e)] = e - g.first_edge(i);
+                _nodes[first_new + i].add_neighbor(first_new + g.head(e), g.weight(e), id(e));
+            }
         }
-        double weight = 1.0;
-        ss >> weight;
-        if (tail != head) {
-            add_edge(tail, head, weight);
+   });
+   if (dirtype == Graph::undirected and input_order) {
+        // as in add_edge_list, the arcs 2i and 2i+1 are the two halves of line i
+        for (CsrGraph::EdgeId e = 0; e < g.num_edges(); ++e) {
+            _reverse_edge[id(e)] = first_id + ((*input_order)[e] ^ 1);
         }
-        else {
-            throw std::runtime_error("Invalid file format: loops not allowed.");
+   } else if (dirtype == Graph::undirected) {
+        std::vector<CsrGraph::EdgeId> reverse = g.reverse_edges();
+        for (CsrGraph::EdgeId e = 0; e < g.num_edges(); ++e) {
+            if (reverse[e] != invalid_edge) {
+                _reverse_edge[first_id + e] = first_id + reverse[e];
+            }
         }
-    linenum++;
+   }
+   if (_use_edge_index) {
+        enable_edge_index();               // rebuild
    }
 }
 
-Graph::Graph(char const * filename, DirType dtype): dirtype(dtype)
-{
-   std::ifstream file(filename);                             // open file
-   if (not file) {
-        throw std::runtime_error("Cannot open file.");
+void Graph::read_from_file(char const * filename, DirType dtype){
+   if (CsrGraph::is_binary(filename)) {
+        add_csr_graph(CsrGraph(filename, dtype));
+   } else {
+        // large files are parsed on several threads
+        std::vector<EdgeList> chunks = read_edge_list_chunks(filename, default_num_threads());
+        if (chunks.size() == 1) {
+            add_edge_list(chunks[0]);
+        } else {
+            // the same edge ids as add_edge_list would give
+            std::vector<EdgeId> input_order;
+            CsrGraph g(chunks, dtype, &input_order);
+            add_csr_graph(g, &input_order);
+        }
    }
+}
 
-   Graph::NodeId num = 0;
-   std::string line;
-   std::getline(file, line);                 // get first line of file
-   std::stringstream ss(line);               // convert line to a stringstream
-   ss >> num;                                // for which we can use >>
-   if (not ss) {
-        throw std::runtime_error("Invalid file format.");
-   }
-   add_nodes(num);
-
-   while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        Graph::NodeId head, tail;
-        ss >> tail >> head;
-        if (not ss) {
-            throw std::runtime_error("Invalid file format.");
-        }
-        double weight = 1.0;
-        ss >> weight;
-        if (tail != head) {
-            add_edge(tail, head, weight);
+Graph::Graph(char const * filename, DirType dtype): dirtype(dtype)
+{
+   read_from_file(filename, dtype);
+}
+Graph::Graph(char const * filename, DirType dtype, char const * data_x, char const * data_y):
+  Graph(filename, dtype)
+{  // data_x and data_y list one coordinate per vertex, in the order of the vertices
+   char const * data_files[2] = {data_x, data_y};
+   for (int index = 0; index < 2; ++index) {
+        std::ifstream file(data_files[index]);
+        if (not file) {
+            throw std::runtime_error("Cannot open file.");
         }
-        else {
-            throw std::runtime_error("Invalid file format: loops not allowed.");
+        for (NodeId i = 0; i < num_nodes(); ++i) {
+            double value;
+            if (not (file >> value)) {
+                throw std::runtime_error("Invalid file format: missing coordinate.");
+            }
+            _nodes[i].set_data(index, value);
         }
    }
 }
+Graph::Graph(const CsrGraph & g): dirtype(g.dirtype)
+{
+   add_csr_graph(g);
+}
 Graph::~Graph(){}
\ No newline at end of file
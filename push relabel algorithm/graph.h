@@ -4,19 +4,27 @@
 
 #include <iostream>
 #include <vector>
+#include "edge_index.h"
+
+struct EdgeList;
+class CsrGraph;
 
 class Graph {
 public:
   using NodeId = int;  // vertices are numbered 0,...,num_nodes()-1
+  using EdgeId = int;  // arcs are numbered in the order they are added; an id stays valid until its arc is removed
+                       // (from a text file: in the order of the lines, see add_edge_list; from a binary file: in its CSR order)
   enum DirType {directed, undirected};  // enum defines a type with possible values
   class Neighbor {
   public:
-        Neighbor(Graph::NodeId n, double w); 
+        Neighbor(Graph::NodeId n, double w, Graph::EdgeId e = -1); 
         double edge_weight() const;
         Graph::NodeId id() const;
+        Graph::EdgeId edge_id() const;
   private:
         Graph::NodeId _id;
         double _edge_weight;
+        Graph::EdgeId _edge_id;
     };
 
   class Edge {
@@ -63,8 +71,11 @@ public:
   public:
     Node();
     ~Node();
-        void add_neighbor(Graph::NodeId nodeid, double weight);
-        void remove_neighbor(Graph::NodeId nodeid);
+        void add_neighbor(Graph::NodeId nodeid, double weight, Graph::EdgeId edge_id = -1);
+        // moves the last arc to position, returns its id (or -1 if position was the last one)
+        Graph::EdgeId remove_neighbor_at(int position);
+        void set_weight_at(int position, double weight);
+        void reserve(int num_neighbors);
         const std::vector<Neighbor> & adjacent_nodes() const;
         const std::vector<double> data() const;
         void set_data(int index, double value);
@@ -77,16 +88,37 @@ public:
   Graph(char const* filename, DirType dirtype);
   Graph(char const * filename, DirType dtype, char const * data_x,  char const * data_y);
   Graph(const Graph & g);
+  Graph(const CsrGraph & g);
   ~Graph(); 
 
   void add_nodes(NodeId num_new_nodes);
-  void add_edge(NodeId tail, NodeId head, double weight = 1.0);
-  void add_edge(Edge e);
+  EdgeId add_edge(NodeId tail, NodeId head, double weight = 1.0);  // returns the id of the arc tail->head
+  EdgeId add_edge(Edge e);
 
   void remove_edge(NodeId tail, NodeId head);
+  void remove_edge(EdgeId e);          // constant time; the order of adjacent_nodes() of the tail changes
+  void set_edge_weight(EdgeId e, double weight);  // in place, the id stays; also sets the reverse half of an undirected edge
+
+  EdgeId find_edge(NodeId a, NodeId b) const;  // some arc a->b, or invalid_edge
+  NodeId edge_tail(EdgeId e) const;
+  NodeId edge_head(EdgeId e) const;
+  int edge_position(EdgeId e) const;       // in adjacent_nodes() of the tail
+  EdgeId reverse_edge(EdgeId e) const;     // the other half of an undirected edge, or invalid_edge
+  EdgeId num_edge_ids() const;             // ids used so far, including removed arcs
+  unsigned long version() const;           // grows with every added vertex or arc, removed arc and changed weight
 
   Edge get_edge(NodeId a, NodeId b);
   Neighbor get_neighbor(NodeId a, NodeId b);
+  int find_neighbor(NodeId a, NodeId b) const;  // position in adjacent_nodes() of a, or -1
+  int num_parallel_edges(NodeId a, NodeId b) const;
+
+  // The optional edge index answers find_edge, find_neighbor, get_neighbor,
+  // get_edge and num_parallel_edges in constant time instead of O(degree).
+  // add_edge and remove_edge keep it up to date.
+  void enable_edge_index();
+  void disable_edge_index();
+  bool has_edge_index() const;
+  std::size_t edge_index_memory() const;        // in bytes
   
   std::vector<Edge> get_edges();
 
@@ -98,11 +130,29 @@ public:
 
   const DirType dirtype;
   static const NodeId invalid_node;
+  static const EdgeId invalid_edge;
   static const double infinite_weight;
 
 private:
   std::vector<Node> _nodes;
+  bool _use_edge_index = false;
+  EdgeIndex _edge_index;
+  // indexed by EdgeId; the position is -1 once the arc is removed
+  std::vector<NodeId> _edge_tail;
+  std::vector<int> _edge_position;
+  std::vector<EdgeId> _reverse_edge;
+  // arcs with the same ends form a circular list (only with the edge index)
+  std::vector<EdgeId> _next_parallel;
+  std::vector<EdgeId> _prev_parallel;
+  unsigned long _version = 0;
+  void check_edge(EdgeId e) const;
+  EdgeId new_arc(NodeId tail, NodeId head, double weight);
+  void link_parallel(EdgeId e, NodeId tail, NodeId head);
+  void remove_arc(EdgeId e);
   void read_from_file(char const * filename, DirType dtype);
+  void add_edge_list(const EdgeList & edges);
+  // arc e of g gets the id num_edge_ids() + e, or + (*input_order)[e]
+  void add_csr_graph(const CsrGraph & g, const std::vector<EdgeId> * input_order = nullptr);
 };
 
 #endif // GRAPH_H
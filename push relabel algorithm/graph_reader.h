@@ -0,0 +1,36 @@
+// graph_reader.h (Bulk Reader for Edge List Files)
+#ifndef GRAPH_READER_H
+#define GRAPH_READER_H
+
+#include <vector>
+#include "graph.h"
+
+// Contents of an edge list file: the first line holds the number of
+// vertices, optionally followed by one b-value per line, then one edge
+// "tail head [weight [cost]]" per line.
+struct EdgeList {
+    Graph::NodeId num_nodes = 0;
+    std::vector<int> bvalues;              // empty unless requested
+    std::vector<Graph::NodeId> tails;
+    std::vector<Graph::NodeId> heads;
+    std::vector<double> weights;
+    std::vector<double> costs;             // empty unless requested; missing costs are 0
+
+    int num_edges() const { return tails.size(); }
+    // number of entries each adjacency list will get
+    std::vector<int> degrees(Graph::DirType dirtype) const;
+};
+
+// Reads the whole file at once and parses it without stringstreams.
+// Throws std::runtime_error with the same messages as Graph used to.
+EdgeList read_edge_list(char const * filename, bool with_bvalues = false,
+                        bool with_costs = false);
+
+// Same, but the edge lines are split into up to num_chunks byte ranges that
+// are parsed on separate threads; small files are not split. Chunk i holds
+// the edges of range i in file order, the b-values are stored in chunk 0.
+std::vector<EdgeList> read_edge_list_chunks(char const * filename, int num_chunks,
+                                            bool with_bvalues = false,
+                                            bool with_costs = false);
+
+#endif // GRAPH_READER_H
@@ -1,7 +1,9 @@
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
 
 #include "flow.h"
+#include "gomory_hu_tree.h"
 using namespace std;
 
 
@@ -10,9 +12,58 @@ int main(int argc, char* argv[])
 {   
     if (argc > 1) 
     {
+    MaxFlowEngine engine = MaxFlowEngine::push_relabel;
+    vector<string> modus;
+    for (int i = 2; i < argc; ++i) //"--engine push_relabel|parallel_push_relabel|capacity_scaling|dinic" und ein Modus mit Argumenten
+    {
+        if (string(argv[i]) == "--engine" && i+1 < argc)
+        {
+            engine = parse_max_flow_engine(argv[++i]);
+        }
+        else
+        {
+            modus.push_back(argv[i]);
+        }
+    }
     Network n(argv[1]);
 
-    Flow * f = n.push_relabel(0,1);
+    if (!modus.empty() && modus[0] == "gomory_hu") //Kanten als ungerichtet; ohne Paardatei: "v parent schnitt" je Knoten außer 0
+    {
+        GomoryHuTree tree(n);
+        if (modus.size() < 2)
+        {
+            for (Graph::NodeId v = 1; v < tree.num_nodes(); ++v)
+            {
+                cout << v << " " << tree.parent(v) << " " << tree.parent_cut(v) << endl;
+            }
+            return 0;
+        }
+        ifstream paare(modus[1]); //Zeilen "s t", je ein Schnittwert als Antwort
+        if (!paare)
+        {
+            throw std::runtime_error("Cannot open pair file.");
+        }
+        for (Graph::NodeId s, t; paare >> s >> t;)
+        {
+            if (s < 0 || t < 0 || s >= tree.num_nodes() || t >= tree.num_nodes())
+            {
+                throw std::runtime_error("Invalid vertex in pair file.");
+            }
+            cout << tree.min_cut(s, t) << endl;
+        }
+        return 0;
+    }
+    if (!modus.empty() && modus[0] == "cut") //nur Schnittwert und Knoten auf der Seite von s
+    {
+        vector<Graph::NodeId> source_side;
+        cout << n.min_cut(0,1,source_side) << endl;
+        for (auto v : source_side)
+        {
+            cout << v << endl;
+        }
+        return 0;
+    }
+    Flow * f = n.max_flow(0,1,engine);
     f->print();
     delete f;
     }
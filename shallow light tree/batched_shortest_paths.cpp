@@ -0,0 +1,77 @@
+// batched_shortest_paths.cpp (Implementation of Class BatchedShortestPaths)
+
+#include <algorithm>
+#include <stdexcept>
+#include "batched_shortest_paths.h"
+
+BatchedShortestPaths::BatchedShortestPaths(const ContractionHierarchy & hierarchy):
+  _hierarchy(hierarchy), _order(hierarchy.num_nodes()), _position(hierarchy.num_nodes()),
+  _first(hierarchy.num_nodes() + 1, 0),
+  _rows(static_cast<size_t>(hierarchy.num_nodes()) * block_size),
+  _upward(hierarchy.num_nodes(), NodeHeap<4>(hierarchy.num_nodes(), false))
+{
+   NodeId n = hierarchy.num_nodes();
+   for (NodeId v = 0; v < n; ++v) {
+        _order[n - 1 - hierarchy.rank(v)] = v;
+   }
+   for (int p = 0; p < n; ++p) {
+        _position[_order[p]] = p;
+   }
+   // downward() keeps the arcs w->v at v already
+   const CsrGraph & down = hierarchy.downward();
+   for (int p = 0; p < n; ++p) {
+        for (auto neighbor: down.adjacent_nodes(_order[p])) {
+            _tails.push_back(_position[neighbor.id()]);
+            _weights.push_back(neighbor.edge_weight());
+        }
+        _first[p + 1] = _tails.size();
+   }
+}
+
+void BatchedShortestPaths::sweep(const NodeId * sources)
+{
+   std::fill(_rows.begin(), _rows.end(), Graph::infinite_weight);
+   for (int j = 0; j < block_size; ++j) {
+        _upward.run(_hierarchy.upward(), sources[j]);
+        for (NodeId v: _upward.settled()) {
+            _rows[static_cast<size_t>(_position[v]) * block_size + j] = _upward.distance(v);
+        }
+   }
+   for (int p = 0; p < static_cast<int>(_order.size()); ++p) {
+        double * row = &_rows[static_cast<size_t>(p) * block_size];
+        for (int a = _first[p]; a < _first[p + 1]; ++a) {
+            const double * tail_row = &_rows[static_cast<size_t>(_tails[a]) * block_size];
+            double weight = _weights[a];
+            for (int j = 0; j < block_size; ++j) {
+                row[j] = std::min(row[j], tail_row[j] + weight);
+            }
+        }
+   }
+}
+
+std::vector<double> BatchedShortestPaths::distances(const std::vector<NodeId> & sources)
+{
+   NodeId n = num_nodes();
+   for (NodeId s: sources) {
+        if (s < 0 or s >= n) {
+            throw std::runtime_error("Invalid source.");
+        }
+   }
+   std::vector<double> result(sources.size() * static_cast<size_t>(n));
+   for (size_t first = 0; first < sources.size(); first += block_size) {
+        // the last block is filled up with copies of its first source
+        int num = std::min<size_t>(block_size, sources.size() - first);
+        NodeId block[block_size];
+        for (int j = 0; j < block_size; ++j) {
+            block[j] = sources[first + (j < num ? j : 0)];
+        }
+        sweep(block);
+        for (NodeId v = 0; v < n; ++v) {
+            const double * row = &_rows[static_cast<size_t>(_position[v]) * block_size];
+            for (int j = 0; j < num; ++j) {
+                result[(first + j) * n + v] = row[j];
+            }
+        }
+   }
+   return result;
+}
@@ -0,0 +1,49 @@
+// batched_shortest_paths.h (Declaration of Class BatchedShortestPaths)
+#ifndef BATCHED_SHORTEST_PATHS_H
+#define BATCHED_SHORTEST_PATHS_H
+
+#include <vector>
+#include "graph.h"
+#include "node_heap.h"
+#include "dijkstra_workspace.h"
+#include "contraction_hierarchy.h"
+
+// Distances from many sources on the same graph (PHAST, Delling et al.).
+// For each source, a search in the upward graph of the hierarchy finds the
+// distances of the vertices above it. A single sweep over all vertices in
+// order of decreasing rank then relaxes the downward arcs into each vertex,
+// which gives every vertex its final distance. The sweep needs no queue and
+// handles block_size sources at once: every vertex has a row of block_size
+// distances, and the rows are stored in sweep order, so relaxing an arc is
+// a short loop of additions and minima that the compiler vectorizes.
+class BatchedShortestPaths {
+public:
+  using NodeId = Graph::NodeId;
+  static constexpr int block_size = 8;      // sources per sweep
+
+  explicit BatchedShortestPaths(const ContractionHierarchy & hierarchy);
+
+  NodeId num_nodes() const { return _order.size(); }
+
+  // a sources.size() x num_nodes() matrix by rows: the distance from
+  // sources[i] to v is entry i * num_nodes() + v (Graph::infinite_weight if
+  // v is not reachable)
+  std::vector<double> distances(const std::vector<NodeId> & sources);
+
+private:
+  // distances from block_size sources into _rows
+  void sweep(const NodeId * sources);
+
+  const ContractionHierarchy & _hierarchy;
+  std::vector<NodeId> _order;          // the vertices by decreasing rank
+  std::vector<int> _position;          // of a vertex in _order
+  // the downward arcs into the vertex at position p, by the position of
+  // their tail (always smaller than p), at _first[p],...,_first[p+1]-1
+  std::vector<int> _first;
+  std::vector<int> _tails;
+  std::vector<double> _weights;
+  std::vector<double> _rows;           // block_size distances per position
+  DijkstraWorkspace<NodeHeap<4>> _upward;
+};
+
+#endif // BATCHED_SHORTEST_PATHS_H
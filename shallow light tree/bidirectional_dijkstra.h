@@ -0,0 +1,83 @@
+// bidirectional_dijkstra.h (Point-to-Point Shortest Paths)
+#ifndef BIDIRECTIONAL_DIJKSTRA_H
+#define BIDIRECTIONAL_DIJKSTRA_H
+
+#include <utility>
+#include <vector>
+#include "graph.h"
+#include "dijkstra_workspace.h"
+
+// Shortest s-t paths by two Dijkstra searches, one forward from s in g and
+// one backward from t in the reverse of g (see CsrGraph::reverse; for an
+// undirected graph, g itself). Every vertex reached by both searches gives
+// an s-t path; the searches stop once the sum of their next keys is at
+// least the shortest of these, which is then a shortest s-t path. The
+// workspaces are kept across queries, as in DijkstraWorkspace.
+template <typename Queue>
+class BidirectionalDijkstra {
+public:
+    using NodeId = Graph::NodeId;
+
+    BidirectionalDijkstra(int num_nodes, Queue forward_queue, Queue backward_queue):
+      _forward(num_nodes, std::move(forward_queue)),
+      _backward(num_nodes, std::move(backward_queue)) {}
+
+    // Returns the s-t distance, Graph::infinite_weight if t is not
+    // reachable from s. G and R are Graph or CsrGraph.
+    template <typename G, typename R>
+    double run(const G & g, const R & reverse, NodeId s, NodeId t)
+    {
+        _forward.start(s);
+        _backward.start(t);
+        _distance = s == t ? 0 : Graph::infinite_weight;
+        _meeting_node = s == t ? s : Graph::invalid_node;
+        auto meet = [this](NodeId v) {
+            double length = _forward.distance(v) + _backward.distance(v);
+            if (length < _distance) {
+                _distance = length;
+                _meeting_node = v;
+            }
+        };
+        while (not _forward.is_done() and not _backward.is_done() and
+               _forward.next_key() + _backward.next_key() < _distance)
+        {
+            if (_forward.next_key() <= _backward.next_key()) {
+                _forward.settle_next(g, meet);
+            }
+            else {
+                _backward.settle_next(reverse, meet);
+            }
+        }
+        return _distance;
+    }
+
+    double distance() const { return _distance; }
+
+    // the vertices of a shortest s-t path of the last run; empty if there is none
+    std::vector<NodeId> path() const
+    {
+        if (_meeting_node == Graph::invalid_node) {
+            return {};
+        }
+        std::vector<NodeId> result = _forward.path(_meeting_node);
+        for (NodeId v = _backward.parent(_meeting_node); v != Graph::invalid_node;
+             v = _backward.parent(v))
+        {
+            result.push_back(v);
+        }
+        return result;
+    }
+
+    int num_settled() const
+    {
+        return _forward.settled().size() + _backward.settled().size();
+    }
+
+private:
+    DijkstraWorkspace<Queue> _forward;
+    DijkstraWorkspace<Queue> _backward;
+    double _distance = Graph::infinite_weight;
+    NodeId _meeting_node = Graph::invalid_node;
+};
+
+#endif // BIDIRECTIONAL_DIJKSTRA_H
@@ -0,0 +1,330 @@
+// bucket_queue.h (Monotone Priority Queues for Integer Keys)
+#ifndef BUCKET_QUEUE_H
+#define BUCKET_QUEUE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "graph.h"
+#include "node_heap.h"
+
+// Both queues below hold vertices keyed by non-negative integers and work like
+// a lazy NodeHeap (see node_heap.h): a vertex is inserted when it is first
+// reached and is then in the heap until it is extracted (settled). They are
+// monotone, i.e. no key may be smaller than the last extracted one, which is
+// what Dijkstra's algorithm needs. A decreased key is stored as a new entry;
+// the outdated one is skipped when it is reached.
+
+// Dial's bucket queue: when all edge weights are integers <= max_weight, the
+// keys in the queue always lie in [min, min + max_weight], so max_weight + 1
+// buckets used in a circle suffice, and extracting scans the buckets in order.
+class DialQueue {
+public:
+    enum class State { unseen, in_heap, settled };
+
+    static const int weight_limit = 1024;   // larger weights need too many buckets
+
+    DialQueue(int num_nodes, int max_weight):
+      _buckets(max_weight + 1), _key(num_nodes, 0), _state(num_nodes, State::unseen) {}
+
+    bool is_empty() const
+    {
+        return _size == 0;
+    }
+
+    bool is_member(Graph::NodeId nodeid) const
+    {
+        return _state[nodeid] == State::in_heap;
+    }
+
+    bool is_settled(Graph::NodeId nodeid) const
+    {
+        return _state[nodeid] == State::settled;
+    }
+
+    double get_key(Graph::NodeId nodeid) const
+    {
+        return _key[nodeid];
+    }
+
+    HeapItem find_min()
+    {
+        if (is_empty()) {
+            throw std::runtime_error("Empty heap; DialQueue::find_min failed.");
+        }
+        while (true) {
+            auto & bucket = _buckets[_current % _buckets.size()];
+            while (not bucket.empty() and not is_current(bucket.back())) {
+                bucket.pop_back();          // outdated entry
+            }
+            if (not bucket.empty()) {
+                return HeapItem(bucket.back(), _current);
+            }
+            ++_current;
+        }
+    }
+
+    Graph::NodeId extract_min()
+    {
+        Graph::NodeId result = find_min()._nodeid;
+        _buckets[_current % _buckets.size()].pop_back();
+        _state[result] = State::settled;
+        --_size;
+        return result;
+    }
+
+    void insert(Graph::NodeId nodeid, double key)
+    {
+        if (_state[nodeid] == State::settled) {
+            throw std::runtime_error("DialQueue: a settled vertex cannot be inserted.");
+        }
+        long long k = std::llround(key);
+        bool decrease = _state[nodeid] == State::in_heap;
+        if (_seen.empty()) {
+            _current = k;                    // the first key since the last clear
+        }
+        if (k < _current or k > _current + static_cast<long long>(_buckets.size()) - 1) {
+            throw std::runtime_error("DialQueue: key out of range.");
+        }
+        if (not decrease) {
+            _seen.push_back(nodeid);
+            ++_size;
+        }
+        _key[nodeid] = k;
+        _state[nodeid] = State::in_heap;
+        _buckets[k % _buckets.size()].push_back(nodeid);
+    }
+
+    void decrease_key(Graph::NodeId nodeid, double new_key)
+    {
+        insert(nodeid, new_key);
+    }
+
+    bool insert_or_decrease_key(Graph::NodeId nodeid, double key)
+    {
+        if (_state[nodeid] == State::settled or
+            (_state[nodeid] == State::in_heap and not (key < _key[nodeid])))
+        {
+            return false;
+        }
+        insert(nodeid, key);
+        return true;
+    }
+
+    // empties the queue and makes all vertices unseen again
+    void clear()
+    {
+        for (auto & bucket: _buckets) {
+            bucket.clear();
+        }
+        for (Graph::NodeId nodeid: _seen) {
+            _state[nodeid] = State::unseen;
+        }
+        _seen.clear();
+        _size = 0;
+        _current = 0;
+    }
+
+private:
+    bool is_current(Graph::NodeId nodeid) const
+    {
+        return _state[nodeid] == State::in_heap and _key[nodeid] == _current;
+    }
+
+    std::vector<std::vector<Graph::NodeId>> _buckets;  // bucket k % size holds key k
+    std::vector<long long> _key;
+    std::vector<State> _state;
+    std::vector<Graph::NodeId> _seen;   // inserted since the last clear
+    long long _current = 0;             // no key in the queue is smaller
+    int _size = 0;                      // number of vertices in the queue
+};
+
+
+// Radix heap: bucket 0 holds the entries whose key equals the last extracted
+// key, bucket i > 0 those whose key first differs from it in bit i-1 (from
+// the top). When bucket 0 runs empty, the first nonempty bucket is split by
+// its minimum key, and every entry moves to a lower bucket; so each entry
+// moves at most 64 times, independently of the size of the weights.
+class RadixHeap {
+public:
+    enum class State { unseen, in_heap, settled };
+
+    static constexpr long long weight_limit = 1LL << 32;   // keeps distances exact in double
+
+    explicit RadixHeap(int num_nodes): _key(num_nodes, 0), _state(num_nodes, State::unseen) {}
+
+    bool is_empty() const
+    {
+        return _size == 0;
+    }
+
+    bool is_member(Graph::NodeId nodeid) const
+    {
+        return _state[nodeid] == State::in_heap;
+    }
+
+    bool is_settled(Graph::NodeId nodeid) const
+    {
+        return _state[nodeid] == State::settled;
+    }
+
+    double get_key(Graph::NodeId nodeid) const
+    {
+        return _key[nodeid];
+    }
+
+    HeapItem find_min()
+    {
+        if (is_empty()) {
+            throw std::runtime_error("Empty heap; RadixHeap::find_min failed.");
+        }
+        auto & first = _buckets[0];
+        while (not first.empty() and not is_current(first.back())) {
+            first.pop_back();
+        }
+        if (first.empty()) {
+            refill();
+        }
+        return HeapItem(first.back().second, _last);
+    }
+
+    Graph::NodeId extract_min()
+    {
+        Graph::NodeId result = find_min()._nodeid;
+        _buckets[0].pop_back();
+        _state[result] = State::settled;
+        --_size;
+        return result;
+    }
+
+    void insert(Graph::NodeId nodeid, double key)
+    {
+        if (_state[nodeid] == State::settled) {
+            throw std::runtime_error("RadixHeap: a settled vertex cannot be inserted.");
+        }
+        if (key < 0 or std::llround(key) < static_cast<long long>(_last)) {
+            throw std::runtime_error("RadixHeap: key out of range.");
+        }
+        if (_state[nodeid] == State::unseen) {
+            _seen.push_back(nodeid);
+            ++_size;
+        }
+        Key k = std::llround(key);
+        _key[nodeid] = k;
+        _state[nodeid] = State::in_heap;
+        _buckets[bucket(k)].emplace_back(k, nodeid);
+    }
+
+    void decrease_key(Graph::NodeId nodeid, double new_key)
+    {
+        insert(nodeid, new_key);
+    }
+
+    bool insert_or_decrease_key(Graph::NodeId nodeid, double key)
+    {
+        if (_state[nodeid] == State::settled or
+            (_state[nodeid] == State::in_heap and not (key < _key[nodeid])))
+        {
+            return false;
+        }
+        insert(nodeid, key);
+        return true;
+    }
+
+    // empties the queue and makes all vertices unseen again
+    void clear()
+    {
+        for (auto & bucket: _buckets) {
+            bucket.clear();
+        }
+        for (Graph::NodeId nodeid: _seen) {
+            _state[nodeid] = State::unseen;
+        }
+        _seen.clear();
+        _size = 0;
+        _last = 0;
+    }
+
+private:
+    using Key = std::uint64_t;
+    using Entry = std::pair<Key, Graph::NodeId>;
+    static const int num_buckets = 65;
+
+    bool is_current(const Entry & entry) const
+    {
+        return _state[entry.second] == State::in_heap and _key[entry.second] == entry.first;
+    }
+
+    int bucket(Key key) const
+    {
+        Key diff = key ^ _last;
+        if (diff == 0) {
+            return 0;
+        }
+        int bit = 0;                  // position of the highest bit of diff
+        for (int shift = 32; shift > 0; shift /= 2) {
+            if (diff >> shift) {
+                diff >>= shift;
+                bit += shift;
+            }
+        }
+        return bit + 1;
+    }
+
+    void refill()                     // moves the next smallest entries to bucket 0
+    {
+        for (int i = 1; i < num_buckets; ++i) {
+            auto & entries = _buckets[i];
+            Key min = 0;
+            bool found = false;
+            for (const Entry & entry: entries) {
+                if (is_current(entry) and (not found or entry.first < min)) {
+                    min = entry.first;
+                    found = true;
+                }
+            }
+            if (found) {
+                _last = min;
+                for (const Entry & entry: entries) {
+                    if (is_current(entry)) {
+                        _buckets[bucket(entry.first)].push_back(entry);
+                    }
+                }
+                entries.clear();
+                return;
+            }
+            entries.clear();          // only outdated entries
+        }
+    }
+
+    std::vector<Entry> _buckets[num_buckets];
+    std::vector<Key> _key;
+    std::vector<State> _state;
+    std::vector<Graph::NodeId> _seen;   // inserted since the last clear
+    Key _last = 0;                      // the last extracted key
+    int _size = 0;                      // number of vertices in the queue
+};
+
+
+// Returns the largest edge weight of g if all weights are integers in
+// [0, limit], and -1 otherwise. G is Graph or CsrGraph.
+template <typename G>
+long long max_integer_weight(const G & g, long long limit)
+{
+    long long result = 0;
+    for (Graph::NodeId v = 0; v < g.num_nodes(); ++v) {
+        for (auto neighbor: g.get_node(v).adjacent_nodes()) {
+            double weight = neighbor.edge_weight();
+            if (not (weight >= 0 and weight <= limit) or weight != std::floor(weight)) {
+                return -1;
+            }
+            result = std::max(result, static_cast<long long>(weight));
+        }
+    }
+    return result;
+}
+
+#endif // BUCKET_QUEUE_H
@@ -0,0 +1,476 @@
+// contraction_hierarchy.cpp (Implementation of Classes ContractionHierarchy and ContractionHierarchyQuery)
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "contraction_hierarchy.h"
+#include "graph_reader.h"
+
+namespace {
+
+using NodeId = Graph::NodeId;
+
+// A witness search gives up after this many vertices. Estimating a priority
+// only needs the number of shortcuts roughly, so it stops much earlier; a
+// missed witness there costs no correctness, only a slightly worse order.
+const int witness_settle_limit = 500;
+const int estimate_settle_limit = 20;
+
+const char file_magic[8] = {'C', 'H', 'I', 'E', 'R', 'A', 'R', 'C'};
+const std::uint32_t file_version = 2;
+
+struct Arc {
+    NodeId other;        // the head of an outgoing arc, the tail of an incoming one
+    double weight;
+    NodeId middle;       // Graph::invalid_node for original arcs
+};
+
+// contracts the vertices of a digraph, keeping the arcs between the
+// vertices not contracted yet in both directions
+class Contractor {
+public:
+    explicit Contractor(const CsrGraph & g);
+    void contract_all();
+
+    std::vector<int> rank;
+    std::vector<std::vector<Arc>> upward;      // at v: arcs v->w, rank(w) > rank(v)
+    std::vector<std::vector<Arc>> downward;    // at v: arcs w->v, rank(w) > rank(v)
+
+private:
+    double priority(NodeId v);
+    int add_shortcuts(NodeId v, bool simulate);
+    void witness_search(NodeId source, NodeId via, double limit, int settle_limit, int num_targets);
+    // add_arc needs the arcs of tail marked
+    void mark_out(NodeId tail);
+    void unmark_out(NodeId tail);
+    void add_arc(NodeId tail, NodeId head, double weight, NodeId middle);
+
+    std::vector<std::vector<Arc>> _out;
+    std::vector<std::vector<Arc>> _in;
+    std::vector<int> _out_position;     // at w: position of the marked arc tail->w in _out[tail], or -1
+    std::vector<int> _contracted_neighbors;
+    NodeHeap<4> _heap;                  // for the witness searches
+    std::vector<double> _dist;
+    std::vector<NodeId> _touched;
+    std::vector<bool> _target;          // the heads of the arcs leaving the vertex being contracted
+};
+
+Contractor::Contractor(const CsrGraph & g):
+  rank(g.num_nodes(), -1), upward(g.num_nodes()), downward(g.num_nodes()),
+  _out(g.num_nodes()), _in(g.num_nodes()), _out_position(g.num_nodes(), -1),
+  _contracted_neighbors(g.num_nodes(), 0),
+  _heap(g.num_nodes(), false), _dist(g.num_nodes(), Graph::infinite_weight),
+  _target(g.num_nodes(), false)
+{
+   for (NodeId v = 0; v < g.num_nodes(); ++v) {
+        for (auto neighbor: g.adjacent_nodes(v)) {
+            if (neighbor.id() != v) {
+                add_arc(v, neighbor.id(), neighbor.edge_weight(), Graph::invalid_node);
+            }
+        }
+        unmark_out(v);
+   }
+}
+
+void Contractor::mark_out(NodeId tail)
+{
+   for (size_t i = 0; i < _out[tail].size(); ++i) {
+        _out_position[_out[tail][i].other] = i;
+   }
+}
+
+void Contractor::unmark_out(NodeId tail)
+{
+   for (const Arc & arc: _out[tail]) {
+        _out_position[arc.other] = -1;
+   }
+}
+
+void Contractor::add_arc(NodeId tail, NodeId head, double weight, NodeId middle)
+{  // keeps only the shortest of parallel arcs
+   if (_out_position[head] == -1) {
+        _out_position[head] = _out[tail].size();
+        _out[tail].push_back({head, weight, middle});
+        _in[head].push_back({tail, weight, middle});
+        return;
+   }
+   Arc * out = &_out[tail][_out_position[head]];
+   if (weight < out->weight) {
+        *out = {head, weight, middle};
+        auto in = std::find_if(_in[head].begin(), _in[head].end(),
+                               [tail](const Arc & arc) { return arc.other == tail; });
+        *in = {tail, weight, middle};
+   }
+}
+
+void Contractor::witness_search(NodeId source, NodeId via, double limit, int settle_limit, int num_targets)
+{  // distances from source without via, as far as limit and settle_limit allow and
+   // until the num_targets targets other than source are settled
+   for (NodeId v: _touched) {
+        _dist[v] = Graph::infinite_weight;
+   }
+   _touched.assign(1, source);
+   _heap.clear();
+   _dist[source] = 0;
+   _heap.insert(source, 0);
+   for (int num_settled = 0; num_settled < settle_limit and num_targets > 0 and
+                             not _heap.is_empty() and _heap.find_min()._key <= limit; ++num_settled)
+   {
+        NodeId u = _heap.extract_min();
+        if (_target[u] and u != source) {
+            --num_targets;
+        }
+        for (const Arc & arc: _out[u]) {
+            double dist = _dist[u] + arc.weight;
+            if (arc.other != via and dist < _dist[arc.other] and
+                _heap.insert_or_decrease_key(arc.other, dist))
+            {
+                if (_dist[arc.other] == Graph::infinite_weight) {
+                    _touched.push_back(arc.other);
+                }
+                _dist[arc.other] = dist;
+            }
+        }
+   }
+}
+
+int Contractor::add_shortcuts(NodeId v, bool simulate)
+{  // returns the number of shortcuts that contracting v needs
+   int num_shortcuts = 0;
+   for (const Arc & out: _out[v]) {
+        _target[out.other] = true;
+   }
+   for (const Arc & in: _in[v]) {
+        double limit = -1;
+        for (const Arc & out: _out[v]) {
+            if (out.other != in.other) {
+                limit = std::max(limit, in.weight + out.weight);
+            }
+        }
+        if (limit < 0) {
+            continue;
+        }
+        int num_targets = _out[v].size() - (_target[in.other] ? 1 : 0);
+        witness_search(in.other, v, limit, simulate ? estimate_settle_limit : witness_settle_limit,
+                       num_targets);
+        if (not simulate) {
+            mark_out(in.other);
+        }
+        for (const Arc & out: _out[v]) {
+            if (out.other != in.other and _dist[out.other] > in.weight + out.weight) {
+                ++num_shortcuts;
+                if (not simulate) {
+                    add_arc(in.other, out.other, in.weight + out.weight, v);
+                }
+            }
+        }
+        if (not simulate) {
+            unmark_out(in.other);
+        }
+   }
+   for (const Arc & out: _out[v]) {
+        _target[out.other] = false;
+   }
+   return num_shortcuts;
+}
+
+double Contractor::priority(NodeId v)
+{  // edge difference plus contracted neighbors, which spreads the contractions
+   int removed = _in[v].size() + _out[v].size();
+   return add_shortcuts(v, true) - removed + _contracted_neighbors[v];
+}
+
+void Contractor::contract_all()
+{
+   NodeId n = rank.size();
+   NodeHeap<4> queue(n, false);
+   for (NodeId v = 0; v < n; ++v) {
+        queue.insert(v, priority(v));
+   }
+   int next_rank = 0;
+   std::vector<NodeId> neighbors;
+   while (not queue.is_empty()) {
+        // lazy update: the priority may have grown since it was computed
+        NodeId v = queue.extract_min();
+        double key = priority(v);
+        if (not queue.is_empty() and key > queue.find_min()._key) {
+            queue.insert(v, key);
+            continue;
+        }
+        rank[v] = next_rank++;
+        upward[v] = _out[v];           // all neighbors are contracted later
+        downward[v] = _in[v];
+        add_shortcuts(v, false);
+
+        neighbors.clear();
+        for (const Arc & arc: _out[v]) {
+            auto & in = _in[arc.other];
+            in.erase(std::find_if(in.begin(), in.end(), [v](const Arc & a) { return a.other == v; }));
+            neighbors.push_back(arc.other);
+        }
+        for (const Arc & arc: _in[v]) {
+            auto & out = _out[arc.other];
+            out.erase(std::find_if(out.begin(), out.end(), [v](const Arc & a) { return a.other == v; }));
+            neighbors.push_back(arc.other);
+        }
+        std::vector<Arc>().swap(_out[v]);
+        std::vector<Arc>().swap(_in[v]);
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+        for (NodeId w: neighbors) {
+            ++_contracted_neighbors[w];
+            queue.remove(w);
+            queue.insert(w, priority(w));
+        }
+   }
+}
+
+// The file written by save; the upward and downward graphs are binary graph
+// files of their own (see CsrGraph::write_binary) next to it.
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t unused;
+    std::int64_t num_nodes;
+    std::int64_t num_upward_arcs;
+    std::int64_t num_downward_arcs;
+};
+
+std::string graph_file(char const * filename, char const * level)
+{
+   return std::string(filename) + "." + level;
+}
+
+template <typename T>
+void write_array(std::ofstream & file, const std::vector<T> & values)
+{
+   file.write(reinterpret_cast<const char *>(values.data()), sizeof(T) * values.size());
+}
+
+template <typename T>
+void read_array(std::ifstream & file, std::vector<T> & values, std::int64_t size)
+{
+   values.resize(size);
+   if (not file.read(reinterpret_cast<char *>(values.data()), sizeof(T) * size)) {
+        throw std::runtime_error("Invalid contraction hierarchy file.");
+   }
+}
+
+}  // namespace
+
+struct ContractionHierarchy::Parts {
+    std::vector<int> rank;
+    CsrGraph upward;
+    CsrGraph downward;
+    std::vector<NodeId> upward_middle;
+    std::vector<NodeId> downward_middle;
+};
+
+ContractionHierarchy::ContractionHierarchy(Parts && parts):
+  _rank(std::move(parts.rank)), _upward(std::move(parts.upward)),
+  _downward(std::move(parts.downward)), _upward_middle(std::move(parts.upward_middle)),
+  _downward_middle(std::move(parts.downward_middle)) {}
+
+ContractionHierarchy::ContractionHierarchy(const CsrGraph & g): ContractionHierarchy([&g]() {
+   Contractor contractor(g);
+   contractor.contract_all();
+   // the arcs are listed by tail, so arc i of an EdgeList is arc i of its CsrGraph
+   auto level = [&g](const std::vector<std::vector<Arc>> & arcs, std::vector<NodeId> & middle) {
+        EdgeList edges;
+        edges.num_nodes = g.num_nodes();
+        for (NodeId v = 0; v < g.num_nodes(); ++v) {
+            for (const Arc & arc: arcs[v]) {
+                edges.tails.push_back(v);
+                edges.heads.push_back(arc.other);
+                edges.weights.push_back(arc.weight);
+                middle.push_back(arc.middle);
+            }
+        }
+        return CsrGraph(edges, Graph::directed);
+   };
+   std::vector<NodeId> upward_middle;
+   std::vector<NodeId> downward_middle;
+   CsrGraph upward = level(contractor.upward, upward_middle);
+   CsrGraph downward = level(contractor.downward, downward_middle);
+   return Parts{std::move(contractor.rank), std::move(upward), std::move(downward),
+                std::move(upward_middle), std::move(downward_middle)};
+}()) {}
+
+ContractionHierarchy::ContractionHierarchy(char const * filename): ContractionHierarchy([filename]() {
+   // the counts are checked against the file size before anything is allocated
+   std::ifstream file(filename, std::ios::binary | std::ios::ate);
+   if (not file) {
+        throw std::runtime_error("Cannot open file.");
+   }
+   std::int64_t file_size = file.tellg();
+   file.seekg(0);
+   FileHeader header;
+   const std::int64_t max_count = std::numeric_limits<int>::max();
+   auto valid_count = [max_count](std::int64_t count) { return count >= 0 and count <= max_count; };
+   if (not file.read(reinterpret_cast<char *>(&header), sizeof(header)) or
+       std::memcmp(header.magic, file_magic, sizeof(file_magic)) != 0 or
+       header.version != file_version or not valid_count(header.num_nodes) or
+       not valid_count(header.num_upward_arcs) or not valid_count(header.num_downward_arcs) or
+       file_size != static_cast<std::int64_t>(sizeof(header) + sizeof(int) * header.num_nodes +
+                        sizeof(NodeId) * (header.num_upward_arcs + header.num_downward_arcs)))
+   {
+        throw std::runtime_error("Invalid contraction hierarchy file.");
+   }
+   std::vector<int> rank;
+   std::vector<NodeId> upward_middle;
+   std::vector<NodeId> downward_middle;
+   read_array(file, rank, header.num_nodes);
+   read_array(file, upward_middle, header.num_upward_arcs);
+   read_array(file, downward_middle, header.num_downward_arcs);
+   Parts parts{std::move(rank), CsrGraph::open_binary(graph_file(filename, "up").c_str()),
+               CsrGraph::open_binary(graph_file(filename, "down").c_str()),
+               std::move(upward_middle), std::move(downward_middle)};
+
+   // Queries and unpack rely on the ranks being a permutation, on every arc
+   // going up in rank and on every middle vertex being contracted before
+   // both ends of its shortcut.
+   NodeId n = header.num_nodes;
+   std::vector<bool> seen(n, false);
+   for (int r: parts.rank) {
+        if (r < 0 or r >= n or seen[r]) {
+            throw std::runtime_error("Invalid contraction hierarchy file.");
+        }
+        seen[r] = true;
+   }
+   for (auto level: {std::make_pair(&parts.upward, &parts.upward_middle),
+                     std::make_pair(&parts.downward, &parts.downward_middle)})
+   {
+        const CsrGraph & g = *level.first;
+        const std::vector<NodeId> & middle = *level.second;
+        if (g.dirtype != Graph::directed or g.num_nodes() != n or
+            g.num_edges() != static_cast<EdgeId>(middle.size()))
+        {
+            throw std::runtime_error("Invalid contraction hierarchy file.");
+        }
+        for (NodeId v = 0; v < n; ++v) {
+            for (EdgeId e = g.first_edge(v); e < g.first_edge(v + 1); ++e) {
+                NodeId m = middle[e];
+                if (parts.rank[g.head(e)] <= parts.rank[v] or
+                    (m != Graph::invalid_node and (m < 0 or m >= n or parts.rank[m] >= parts.rank[v])))
+                {
+                    throw std::runtime_error("Invalid contraction hierarchy file.");
+                }
+            }
+        }
+   }
+   return parts;
+}()) {}
+
+void ContractionHierarchy::save(char const * filename) const
+{  // header, ranks and the middles of upward() and downward(); the graphs
+   // themselves go to filename.up and filename.down
+   FileHeader header;
+   std::memset(&header, 0, sizeof(header));
+   std::memcpy(header.magic, file_magic, sizeof(file_magic));
+   header.version = file_version;
+   header.num_nodes = num_nodes();
+   header.num_upward_arcs = _upward.num_edges();
+   header.num_downward_arcs = _downward.num_edges();
+   std::ofstream file(filename, std::ios::binary);
+   if (not file) {
+        throw std::runtime_error("Cannot open file.");
+   }
+   file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+   write_array(file, _rank);
+   write_array(file, _upward_middle);
+   write_array(file, _downward_middle);
+   if (not file) {
+        throw std::runtime_error("Cannot write file.");
+   }
+   _upward.write_binary(graph_file(filename, "up").c_str());
+   _downward.write_binary(graph_file(filename, "down").c_str());
+}
+
+std::vector<ContractionHierarchy::NodeId> ContractionHierarchy::unpack(NodeId tail, NodeId head) const
+{
+   std::vector<NodeId> result;
+   std::vector<std::pair<NodeId, NodeId>> stack(1, {tail, head});
+   while (not stack.empty()) {
+        NodeId a = stack.back().first;
+        NodeId b = stack.back().second;
+        stack.pop_back();
+        // a->b is stored at the end with the lower rank
+        bool up = rank(a) < rank(b);
+        const CsrGraph & g = up ? _upward : _downward;
+        NodeId from = up ? a : b;
+        NodeId to = up ? b : a;
+        EdgeId e = g.first_edge(from);
+        while (e < g.first_edge(from + 1) and g.head(e) != to) {
+            ++e;
+        }
+        if (e == g.first_edge(from + 1)) {
+            throw std::runtime_error("No such arc in the contraction hierarchy.");
+        }
+        NodeId middle = up ? _upward_middle[e] : _downward_middle[e];
+        if (middle == Graph::invalid_node) {
+            result.push_back(b);
+        } else {
+            stack.push_back({middle, b});
+            stack.push_back({a, middle});
+        }
+   }
+   return result;
+}
+
+ContractionHierarchyQuery::ContractionHierarchyQuery(const ContractionHierarchy & hierarchy):
+  _hierarchy(hierarchy),
+  _forward(hierarchy.num_nodes(), NodeHeap<4>(hierarchy.num_nodes(), false)),
+  _backward(hierarchy.num_nodes(), NodeHeap<4>(hierarchy.num_nodes(), false)) {}
+
+double ContractionHierarchyQuery::run(NodeId s, NodeId t)
+{
+   _forward.start(s);
+   _backward.start(t);
+   _distance = s == t ? 0 : Graph::infinite_weight;
+   _meeting_node = s == t ? s : Graph::invalid_node;
+   auto meet = [this](NodeId v) {
+        double length = _forward.distance(v) + _backward.distance(v);
+        if (length < _distance) {
+            _distance = length;
+            _meeting_node = v;
+        }
+   };
+   while (true) {
+        bool forward = not _forward.is_done() and _forward.next_key() < _distance;
+        bool backward = not _backward.is_done() and _backward.next_key() < _distance;
+        if (forward and (not backward or _forward.next_key() <= _backward.next_key())) {
+            _forward.settle_next(_hierarchy.upward(), meet);
+        } else if (backward) {
+            _backward.settle_next(_hierarchy.downward(), meet);
+        } else {
+            return _distance;
+        }
+   }
+}
+
+std::vector<ContractionHierarchyQuery::NodeId> ContractionHierarchyQuery::path() const
+{
+   if (_meeting_node == Graph::invalid_node) {
+        return {};
+   }
+   std::vector<NodeId> hops = _forward.path(_meeting_node);
+   for (NodeId v = _backward.parent(_meeting_node); v != Graph::invalid_node; v = _backward.parent(v)) {
+        hops.push_back(v);
+   }
+   std::vector<NodeId> result(1, hops[0]);
+   for (size_t i = 1; i < hops.size(); ++i) {
+        std::vector<NodeId> part = _hierarchy.unpack(hops[i - 1], hops[i]);
+        result.insert(result.end(), part.begin(), part.end());
+   }
+   return result;
+}
+
+int ContractionHierarchyQuery::num_settled() const
+{
+   return _forward.settled().size() + _backward.settled().size();
+}
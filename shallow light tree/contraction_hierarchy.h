@@ -0,0 +1,88 @@
+// contraction_hierarchy.h (Declaration of Classes ContractionHierarchy and ContractionHierarchyQuery)
+#ifndef CONTRACTION_HIERARCHY_H
+#define CONTRACTION_HIERARCHY_H
+
+#include <vector>
+#include "graph.h"
+#include "csr_graph.h"
+#include "node_heap.h"
+#include "dijkstra_workspace.h"
+
+// Contraction hierarchy of a static digraph for fast s-t distance queries.
+// The vertices are contracted one by one, the one with the smallest edge
+// difference (shortcuts added minus arcs removed, plus the number of
+// contracted neighbors) first. Contracting v adds a shortcut u->w with
+// middle vertex v for every path u->v->w that is the only shortest u-w path
+// the witness search finds. Afterwards every shortest path has a shortest
+// path counterpart that only goes up in rank and then only down.
+class ContractionHierarchy {
+public:
+  using NodeId = Graph::NodeId;
+  using EdgeId = CsrGraph::EdgeId;
+
+  // Preprocessing; an undirected graph counts as a digraph with both arcs.
+  explicit ContractionHierarchy(const CsrGraph & g);
+  // reads a hierarchy written by save; throws if the files are damaged
+  explicit ContractionHierarchy(char const * filename);
+
+  // writes the ranks and middle vertices to filename, and upward() and
+  // downward() as binary graph files (CsrGraph::write_binary) to
+  // filename.up and filename.down
+  void save(char const * filename) const;
+
+  NodeId num_nodes() const { return _rank.size(); }
+  int rank(NodeId v) const { return _rank[v]; }       // position in the contraction order
+
+  // Arc v->w of upward() is an arc (or shortcut) v->w with rank(w) > rank(v);
+  // arc v->w of downward() stands for the arc w->v with rank(w) > rank(v).
+  const CsrGraph & upward() const { return _upward; }
+  const CsrGraph & downward() const { return _downward; }
+  // the middle vertex of a shortcut, Graph::invalid_node for original arcs
+  NodeId upward_middle(EdgeId e) const { return _upward_middle[e]; }
+  NodeId downward_middle(EdgeId e) const { return _downward_middle[e]; }
+
+  // Replaces the arc or shortcut tail->head of the hierarchy by the path of
+  // original arcs it stands for; returns its vertices except tail.
+  std::vector<NodeId> unpack(NodeId tail, NodeId head) const;
+
+private:
+  struct Parts;
+
+  explicit ContractionHierarchy(Parts && parts);
+
+  std::vector<int> _rank;
+  CsrGraph _upward;
+  CsrGraph _downward;
+  std::vector<NodeId> _upward_middle;
+  std::vector<NodeId> _downward_middle;
+};
+
+
+// Answers s-t queries with a forward search from s in upward() and a
+// backward search from t in downward(). Each search stops once its next key
+// is no smaller than the shortest s-t path found so far. The buffers are
+// kept across queries; use one object per thread.
+class ContractionHierarchyQuery {
+public:
+  using NodeId = Graph::NodeId;
+
+  explicit ContractionHierarchyQuery(const ContractionHierarchy & hierarchy);
+
+  // the s-t distance, Graph::infinite_weight if t is not reachable from s
+  double run(NodeId s, NodeId t);
+
+  double distance() const { return _distance; }
+  // the vertices of a shortest s-t path in the original graph, found by
+  // unpacking the shortcuts; empty if there is none
+  std::vector<NodeId> path() const;
+  int num_settled() const;
+
+private:
+  const ContractionHierarchy & _hierarchy;
+  DijkstraWorkspace<NodeHeap<4>> _forward;
+  DijkstraWorkspace<NodeHeap<4>> _backward;
+  double _distance = Graph::infinite_weight;
+  NodeId _meeting_node = Graph::invalid_node;
+};
+
+#endif // CONTRACTION_HIERARCHY_H
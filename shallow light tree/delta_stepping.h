@@ -0,0 +1,289 @@
+// delta_stepping.h (Parallel Single-Source Shortest Paths)
+#ifndef DELTA_STEPPING_H
+#define DELTA_STEPPING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "graph.h"
+#include "parallel.h"
+
+// A bucket width for delta_stepping: the mean arc weight divided by the mean
+// out-degree, so that a vertex has about one light arc (weight <= delta)
+// leading into its own bucket. The result is never below the smallest
+// positive weight, and 1 if there is none.
+template <typename G>
+double delta_stepping_width(const G & g)
+{
+    double sum = 0;
+    double min_positive = Graph::infinite_weight;
+    long long num_arcs = 0;
+    for (Graph::NodeId v = 0; v < g.num_nodes(); ++v) {
+        for (auto neighbor: g.get_node(v).adjacent_nodes()) {
+            sum += neighbor.edge_weight();
+            ++num_arcs;
+            if (neighbor.edge_weight() > 0) {
+                min_positive = std::min(min_positive, neighbor.edge_weight());
+            }
+        }
+    }
+    if (min_positive == Graph::infinite_weight) {
+        return 1;
+    }
+    double mean_degree = static_cast<double>(num_arcs) / g.num_nodes();
+    return std::max(min_positive, sum / num_arcs / mean_degree);
+}
+
+
+// Delta-stepping (Meyer and Sanders): the vertices wait in buckets of width
+// delta by tentative distance. The lowest bucket is emptied in rounds that
+// relax the light arcs (weight <= delta) of its vertices, which may refill
+// it; then the heavy arcs of all vertices removed from it are relaxed once.
+// Within a round every thread relaxes the arcs of its share of the bucket
+// and lowers distances with an atomic minimum. Only the relaxation that set
+// the final value of a round sets the parent, so the parents form a
+// shortest paths tree, as with Dijkstra's algorithm. The buffers are kept
+// across runs.
+class DeltaStepping {
+public:
+    using NodeId = Graph::NodeId;
+    // the buckets of a thread form a ring of at most this many; entries
+    // further ahead wait in a heap until the ring reaches them
+    static constexpr long long max_ring_size = 1 << 16;
+
+    explicit DeltaStepping(int num_nodes):
+      _dist(num_nodes), _parent(num_nodes), _parent_weight(num_nodes),
+      _round(num_nodes), _heavy_bucket(num_nodes) {}
+
+    // G is Graph or CsrGraph, with non-negative weights
+    template <typename G>
+    void run(const G & g, NodeId source, double delta, int num_threads = default_num_threads())
+    {
+        if (not (delta > 0) or num_threads < 1) {
+            throw std::runtime_error("Invalid bucket width or number of threads.");
+        }
+        NodeId n = g.num_nodes();
+        for (NodeId v = 0; v < n; ++v) {
+            _dist[v].store(Graph::infinite_weight, std::memory_order_relaxed);
+            _parent[v] = Graph::invalid_node;
+            _parent_weight[v] = 0;
+            _round[v].store(-1, std::memory_order_relaxed);
+            _heavy_bucket[v].store(-1, std::memory_order_relaxed);
+        }
+        _delta = delta;
+        double max_weight = 0;
+        for (NodeId v = 0; v < n; ++v) {
+            for (auto neighbor: g.get_node(v).adjacent_nodes()) {
+                if (not (neighbor.edge_weight() >= 0)) {
+                    throw std::runtime_error("Delta-stepping needs non-negative weights.");
+                }
+                max_weight = std::max(max_weight, neighbor.edge_weight());
+            }
+        }
+        // live entries lie in buckets i,...,i+max_weight/delta+1, so the
+        // buckets are kept in a ring of that size (or max_ring_size)
+        int num_buckets = static_cast<int>(std::min<double>(max_weight / delta + 2, max_ring_size));
+        _dist[source].store(0, std::memory_order_relaxed);
+
+        std::vector<Worker> workers(num_threads, Worker(num_buckets));
+        workers[0].buckets[0].push_back(source);
+        Barrier barrier(num_threads);
+        std::atomic<long long> next_bucket(0);
+        std::atomic<bool> refilled(false);
+
+        parallel_for(num_threads, [&](int id) {
+            Worker & worker = workers[id];
+            int round = 0;
+            long long current = 0;
+            while (true) {
+                // the lowest non-empty bucket over all threads
+                long long mine = worker.lowest_bucket(current);
+                if (id == 0) {
+                    next_bucket.store(mine, std::memory_order_relaxed);
+                }
+                barrier.wait();
+                if (id != 0) {
+                    long long seen = next_bucket.load(std::memory_order_relaxed);
+                    while (mine < seen and
+                           not next_bucket.compare_exchange_weak(seen, mine, std::memory_order_relaxed)) {
+                    }
+                }
+                barrier.wait();
+                long long i = next_bucket.load(std::memory_order_relaxed);
+                if (i == Worker::no_bucket) {
+                    break;
+                }
+                current = i;
+                worker.refill(i);
+                worker.removed.clear();
+                while (true) {      // rounds on the light arcs
+                    worker.take_bucket(i, *this, ++round);
+                    if (id == 0) {
+                        refilled.store(false, std::memory_order_relaxed);
+                    }
+                    for (NodeId v: worker.frontier) {
+                        relax(g, v, worker, true);
+                    }
+                    barrier.wait();
+                    worker.resolve(*this, i);
+                    if (not worker.buckets[i % worker.buckets.size()].empty()) {
+                        refilled.store(true, std::memory_order_relaxed);
+                    }
+                    barrier.wait();
+                    if (not refilled.load(std::memory_order_relaxed)) {
+                        break;
+                    }
+                    barrier.wait();      // everyone has read refilled before it is reset
+                }
+                for (NodeId v: worker.removed) {
+                    if (_heavy_bucket[v].exchange(i, std::memory_order_relaxed) != i) {
+                        relax(g, v, worker, false);
+                    }
+                }
+                barrier.wait();
+                worker.resolve(*this, i);
+                barrier.wait();
+            }
+        });
+    }
+
+    // Graph::infinite_weight if v is not reachable from the source
+    double distance(NodeId v) const { return _dist[v].load(std::memory_order_relaxed); }
+    NodeId parent(NodeId v) const { return _parent[v]; }        // Graph::invalid_node for the source
+    double parent_weight(NodeId v) const { return _parent_weight[v]; }
+
+    // the shortest paths tree of the reachable vertices
+    Graph tree(Graph::DirType dirtype) const
+    {
+        Graph result(static_cast<NodeId>(_parent.size()), dirtype);
+        for (NodeId v = 0; v < static_cast<NodeId>(_parent.size()); ++v) {
+            if (_parent[v] != Graph::invalid_node) {
+                result.add_edge(_parent[v], v, _parent_weight[v]);
+            }
+        }
+        return result;
+    }
+
+private:
+    struct Request {
+        NodeId node;
+        double dist;
+        NodeId parent;
+        double weight;
+    };
+
+    struct Worker {
+        static constexpr long long no_bucket = std::numeric_limits<long long>::max();
+
+        explicit Worker(int num_buckets): buckets(num_buckets) {}
+
+        long long lowest_bucket(long long from) const
+        {
+            long long size = buckets.size();
+            long long lowest = overflow.empty() ? no_bucket : overflow.top().first;
+            for (long long i = from; i < std::min(from + size, lowest); ++i) {
+                if (not buckets[i % size].empty()) {
+                    return i;
+                }
+            }
+            return lowest;
+        }
+
+        // puts v into bucket i; the ring holds the buckets current,...,
+        // current+size-1, so that no two of its buckets share a slot
+        void put(NodeId v, long long i, long long current)
+        {
+            long long size = buckets.size();
+            if (i < current + size) {
+                buckets[i % size].push_back(v);
+            } else {
+                overflow.push({i, v});
+            }
+        }
+
+        // moves the entries that the ring reaches from bucket current on
+        void refill(long long current)
+        {
+            while (not overflow.empty() and overflow.top().first < current + static_cast<long long>(buckets.size())) {
+                buckets[overflow.top().first % buckets.size()].push_back(overflow.top().second);
+                overflow.pop();
+            }
+        }
+
+        // moves the vertices of bucket i that still belong there to
+        // frontier, each once per round
+        void take_bucket(long long i, DeltaStepping & search, int round)
+        {
+            frontier.clear();
+            std::vector<NodeId> & bucket = buckets[i % buckets.size()];
+            for (NodeId v: bucket) {
+                if (search.bucket_of(search.distance(v)) == i and
+                    search._round[v].exchange(round, std::memory_order_relaxed) != round)
+                {
+                    frontier.push_back(v);
+                    removed.push_back(v);
+                }
+            }
+            bucket.clear();
+        }
+
+        // for the relaxations of this thread that are still the lowest:
+        // sets the parent and puts the vertex into its bucket
+        void resolve(DeltaStepping & search, long long current)
+        {
+            for (const Request & request: requests) {
+                if (search.distance(request.node) == request.dist) {
+                    search._parent[request.node] = request.parent;
+                    search._parent_weight[request.node] = request.weight;
+                    put(request.node, search.bucket_of(request.dist), current);
+                }
+            }
+            requests.clear();
+        }
+
+        std::vector<std::vector<NodeId>> buckets;
+        // (bucket, vertex) beyond the ring, lowest bucket first
+        std::priority_queue<std::pair<long long, NodeId>, std::vector<std::pair<long long, NodeId>>,
+                            std::greater<std::pair<long long, NodeId>>> overflow;
+        std::vector<NodeId> frontier;
+        std::vector<NodeId> removed;        // from the current bucket, for the heavy arcs
+        std::vector<Request> requests;
+    };
+
+    long long bucket_of(double dist) const { return static_cast<long long>(dist / _delta); }
+
+    template <typename G>
+    void relax(const G & g, NodeId v, Worker & worker, bool light)
+    {
+        double dist_v = distance(v);
+        for (auto neighbor: g.get_node(v).adjacent_nodes()) {
+            if ((neighbor.edge_weight() <= _delta) != light) {
+                continue;
+            }
+            NodeId w = neighbor.id();
+            double dist = dist_v + neighbor.edge_weight();
+            double old = _dist[w].load(std::memory_order_relaxed);
+            while (dist < old and
+                   not _dist[w].compare_exchange_weak(old, dist, std::memory_order_relaxed)) {
+            }
+            if (dist < old) {
+                worker.requests.push_back({w, dist, v, neighbor.edge_weight()});
+            }
+        }
+    }
+
+    std::vector<std::atomic<double>> _dist;
+    std::vector<NodeId> _parent;
+    std::vector<double> _parent_weight;
+    std::vector<std::atomic<int>> _round;          // the last light round that took the vertex
+    std::vector<std::atomic<long long>> _heavy_bucket;   // the last bucket that relaxed its heavy arcs
+    double _delta = 1;
+};
+
+#endif // DELTA_STEPPING_H
@@ -0,0 +1,169 @@
+// dijkstra_workspace.h (Dijkstra's Algorithm for Repeated Queries)
+#ifndef DIJKSTRA_WORKSPACE_H
+#define DIJKSTRA_WORKSPACE_H
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "graph.h"
+#include "node_heap.h"
+#include "bucket_queue.h"
+
+// Runs Dijkstra's algorithm on graphs with num_nodes vertices and keeps all
+// buffers from one query to the next. Only the entries the previous query
+// has touched are reset, so a query costs time proportional to the region
+// it explores, not to the size of the graph. Queue is NodeHeap<Arity>,
+// DialQueue or RadixHeap (see node_heap.h, bucket_queue.h), constructed
+// empty.
+template <typename Queue>
+class DijkstraWorkspace {
+public:
+    using NodeId = Graph::NodeId;
+
+    DijkstraWorkspace(int num_nodes, Queue queue):
+      _queue(std::move(queue)), _dist(num_nodes, Graph::infinite_weight),
+      _parent(num_nodes, Graph::invalid_node), _parent_weight(num_nodes, 0.0) {}
+
+    // Settles the vertices of g in order of their distance from source; if a
+    // target is given, stops as soon as it is settled. G is Graph or CsrGraph.
+    template <typename G>
+    void run(const G & g, NodeId source, NodeId target = Graph::invalid_node)
+    {
+        start(source);
+        while (not is_done() and settle_next(g) != target) {
+        }
+    }
+
+    // The same search step by step: start() resets the workspace, and every
+    // settle_next() settles the vertex with the smallest key, next_key(), and
+    // calls improved(w) for each w whose distance it decreases. With a
+    // potential, the key of w is its distance plus potential(w) (A*); the
+    // potential must be consistent, i.e. potential(v) <= weight(v,w) +
+    // potential(w) for every arc, so that settled distances are final, and
+    // the bucket queues need integer potentials.
+    void start(NodeId source)
+    {
+        reset();
+        _source = source;
+        _dist[source] = 0;
+        _reached.push_back(source);
+        _queue.insert(source, 0);
+    }
+
+    bool is_done() const { return _queue.is_empty(); }
+    double next_key() { return _queue.find_min()._key; }
+
+    template <typename G, typename F, typename P>
+    NodeId settle_next(const G & g, F improved, const P & potential)
+    {
+        NodeId nodeid = _queue.extract_min();
+        double key = _dist[nodeid];
+        _settled.push_back(nodeid);
+        for (auto neighbor: g.get_node(nodeid).adjacent_nodes()) {
+            NodeId w = neighbor.id();
+            double dist = key + neighbor.edge_weight();
+            if (dist < _dist[w] and _queue.insert_or_decrease_key(w, dist + potential(w))) {
+                if (_dist[w] == Graph::infinite_weight) {
+                    _reached.push_back(w);
+                }
+                _dist[w] = dist;
+                _parent[w] = nodeid;
+                _parent_weight[w] = neighbor.edge_weight();
+                improved(w);
+            }
+        }
+        return nodeid;
+    }
+
+    template <typename G, typename F>
+    NodeId settle_next(const G & g, F improved)
+    {
+        return settle_next(g, improved, [](NodeId) { return 0.0; });
+    }
+
+    template <typename G>
+    NodeId settle_next(const G & g)
+    {
+        return settle_next(g, [](NodeId) {});
+    }
+
+    NodeId source() const { return _source; }
+    bool is_settled(NodeId v) const { return _queue.is_settled(v); }
+    // tentative for vertices that are reached but not settled;
+    // Graph::infinite_weight for vertices that are not reached
+    double distance(NodeId v) const { return _dist[v]; }
+    NodeId parent(NodeId v) const { return _parent[v]; }         // Graph::invalid_node for the source
+    double parent_weight(NodeId v) const { return _parent_weight[v]; }
+
+    // all vertices the last query reached, and those it settled, in order
+    const std::vector<NodeId> & reached() const { return _reached; }
+    const std::vector<NodeId> & settled() const { return _settled; }
+
+    // the vertices of a shortest path from the source to a settled vertex
+    std::vector<NodeId> path(NodeId target) const
+    {
+        std::vector<NodeId> result;
+        for (NodeId v = target; v != Graph::invalid_node; v = _parent[v]) {
+            result.push_back(v);
+        }
+        std::reverse(result.begin(), result.end());
+        return result;
+    }
+
+    // Adds the edges of the shortest paths tree of the settled vertices to
+    // result, which needs num_nodes vertices. Repeated queries should not
+    // build a Graph each time; the tree is parent(v) and parent_weight(v) for
+    // the vertices v in settled() other than source().
+    void tree(Graph & result) const
+    {
+        for (NodeId v: _settled) {
+            if (v != _source) {
+                result.add_edge(_parent[v], v, _parent_weight[v]);
+            }
+        }
+    }
+
+private:
+    void reset()
+    {
+        for (NodeId v: _reached) {
+            _dist[v] = Graph::infinite_weight;
+            _parent[v] = Graph::invalid_node;
+        }
+        _reached.clear();
+        _settled.clear();
+        _queue.clear();
+    }
+
+    Queue _queue;
+    std::vector<double> _dist;
+    std::vector<NodeId> _parent;
+    std::vector<double> _parent_weight;
+    std::vector<NodeId> _reached;
+    std::vector<NodeId> _settled;
+    NodeId _source = Graph::invalid_node;
+};
+
+
+// Calls f(workspace) with a new workspace for g and returns its result. The
+// queue suits the weights of g: Dial's bucket queue if they are integers in
+// [0, DialQueue::weight_limit], a radix heap if they are larger integers,
+// and a NodeHeap<Arity> otherwise.
+template <int Arity = 2, typename G, typename F>
+auto with_dijkstra_workspace(const G & g, F f)
+{
+    Graph::NodeId n = g.num_nodes();
+    long long max_weight = max_integer_weight(g, RadixHeap::weight_limit);
+    if (max_weight >= 0 and max_weight <= DialQueue::weight_limit) {
+        DijkstraWorkspace<DialQueue> workspace(n, DialQueue(n, max_weight));
+        return f(workspace);
+    }
+    if (max_weight >= 0) {
+        DijkstraWorkspace<RadixHeap> workspace(n, RadixHeap(n));
+        return f(workspace);
+    }
+    DijkstraWorkspace<NodeHeap<Arity>> workspace(n, NodeHeap<Arity>(n, false));
+    return f(workspace);
+}
+
+#endif // DIJKSTRA_WORKSPACE_H
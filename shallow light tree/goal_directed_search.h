@@ -0,0 +1,183 @@
+// goal_directed_search.h (A* Search with Euclidean and Landmark Bounds)
+#ifndef GOAL_DIRECTED_SEARCH_H
+#define GOAL_DIRECTED_SEARCH_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "graph.h"
+#include "node_heap.h"
+#include "dijkstra_workspace.h"
+
+// A potential is a lower bound on the distance from a vertex to the target
+// set by set_target(t). Both potentials below are consistent (see
+// DijkstraWorkspace::start), so A* settles every vertex with its final
+// distance.
+
+// Euclidean distance to the target, from the coordinates stored with the
+// vertices (Graph::Node::data(), see the Graph constructor with the data_x
+// and data_y files). It is scaled by the smallest ratio weight / length over
+// all arcs, so that it never exceeds the length of a path even if the
+// weights are e.g. travel times rather than lengths.
+class EuclideanPotential {
+public:
+    using NodeId = Graph::NodeId;
+
+    explicit EuclideanPotential(const Graph & g): _x(g.num_nodes()), _y(g.num_nodes())
+    {
+        for (NodeId v = 0; v < g.num_nodes(); ++v) {
+            std::vector<double> data = g.get_node(v).data();
+            _x[v] = data[0];
+            _y[v] = data[1];
+        }
+        _scale = Graph::infinite_weight;
+        for (NodeId v = 0; v < g.num_nodes(); ++v) {
+            for (auto neighbor: g.get_node(v).adjacent_nodes()) {
+                double length = std::hypot(_x[v] - _x[neighbor.id()], _y[v] - _y[neighbor.id()]);
+                if (length > 0) {
+                    _scale = std::min(_scale, neighbor.edge_weight() / length);
+                }
+            }
+        }
+        // no arc with a length: no information; otherwise leave room for rounding
+        _scale = _scale == Graph::infinite_weight ? 0 : _scale * (1 - 1e-9);
+    }
+
+    void set_target(NodeId target)
+    {
+        _target_x = _x[target];
+        _target_y = _y[target];
+    }
+
+    double operator()(NodeId v) const
+    {
+        return _scale * std::hypot(_x[v] - _target_x, _y[v] - _target_y);
+    }
+
+    double scale() const { return _scale; }
+
+private:
+    std::vector<double> _x;
+    std::vector<double> _y;
+    double _scale;
+    double _target_x = 0;
+    double _target_y = 0;
+};
+
+
+// ALT bounds from the triangle inequality: for every landmark L,
+// dist(v,t) >= dist(L,t) - dist(L,v) and dist(v,t) >= dist(v,L) - dist(t,L).
+// Needs no coordinates, but two distance tables per landmark (one for
+// undirected graphs), kept with the landmarks of a vertex next to each other.
+class LandmarkPotential {
+public:
+    using NodeId = Graph::NodeId;
+
+    // Picks num_landmarks landmarks greedily, each as far as possible from
+    // the ones before (the first one as far as possible from vertex 0), and
+    // computes their distances. G and R are Graph or CsrGraph; reverse is
+    // the reverse of g (see CsrGraph::reverse; for undirected graphs, g).
+    template <typename G, typename R>
+    LandmarkPotential(const G & g, const R & reverse, int num_landmarks):
+      _num_landmarks(std::min<int>(num_landmarks, g.num_nodes())),
+      _symmetric(g.dirtype == Graph::undirected),
+      _from(static_cast<size_t>(g.num_nodes()) * _num_landmarks, Graph::infinite_weight),
+      _to(_symmetric ? 0 : _from.size(), Graph::infinite_weight),
+      _target_from(_num_landmarks), _target_to(_num_landmarks)
+    {
+        NodeId n = g.num_nodes();
+        DijkstraWorkspace<NodeHeap<4>> workspace(n, NodeHeap<4>(n, false));
+        std::vector<double> closest(n, Graph::infinite_weight);   // distance from the nearest landmark
+        NodeId next = 0;
+        if (n > 0) {
+            workspace.run(g, 0);
+            next = workspace.settled().back();
+        }
+        for (int i = 0; i < _num_landmarks; ++i) {
+            _landmarks.push_back(next);
+            workspace.run(g, next);
+            for (NodeId v: workspace.settled()) {
+                _from[index(v, i)] = workspace.distance(v);
+                closest[v] = std::min(closest[v], workspace.distance(v));
+            }
+            if (not _symmetric) {
+                workspace.run(reverse, next);
+                for (NodeId v: workspace.settled()) {
+                    _to[index(v, i)] = workspace.distance(v);
+                }
+            }
+            // the next landmark is the reached vertex farthest from all landmarks so far
+            for (NodeId v = 0; v < n; ++v) {
+                if (closest[v] != Graph::infinite_weight and
+                    (closest[next] == Graph::infinite_weight or closest[v] > closest[next]))
+                {
+                    next = v;
+                }
+            }
+        }
+    }
+
+    void set_target(NodeId target)
+    {
+        for (int i = 0; i < _num_landmarks; ++i) {
+            _target_from[i] = _from[index(target, i)];
+            _target_to[i] = _symmetric ? _target_from[i] : _to[index(target, i)];
+        }
+    }
+
+    double operator()(NodeId v) const
+    {
+        const double * from = &_from[index(v, 0)];
+        const double * to = _symmetric ? from : &_to[index(v, 0)];
+        double bound = 0;
+        for (int i = 0; i < _num_landmarks; ++i) {
+            bound = std::max(bound, difference(_target_from[i], from[i]));
+            bound = std::max(bound, difference(to[i], _target_to[i]));
+        }
+        return bound;
+    }
+
+    const std::vector<NodeId> & landmarks() const { return _landmarks; }
+
+private:
+    size_t index(NodeId v, int landmark) const
+    {
+        return static_cast<size_t>(v) * _num_landmarks + landmark;
+    }
+
+    // a - b as a lower bound; no information if b is infinite, and an
+    // infinite bound if only a is (then the target cannot be reached)
+    static double difference(double a, double b)
+    {
+        return b == Graph::infinite_weight ? 0 : a - b;
+    }
+
+    int _num_landmarks;
+    bool _symmetric;                    // undirected: _to is _from
+    std::vector<double> _from;          // dist(landmark, v)
+    std::vector<double> _to;            // dist(v, landmark)
+    std::vector<double> _target_from;
+    std::vector<double> _target_to;
+    std::vector<NodeId> _landmarks;
+};
+
+
+// A* search from source to target with the given potential; returns the
+// distance, Graph::infinite_weight if target cannot be reached. The path and
+// the settled vertices can be read from workspace afterwards, whose queue
+// must be a NodeHeap.
+template <typename Queue, typename G, typename P>
+double astar_search(const G & g, Graph::NodeId source, Graph::NodeId target,
+                    P & potential, DijkstraWorkspace<Queue> & workspace)
+{
+    potential.set_target(target);
+    workspace.start(source);
+    while (not workspace.is_done()) {
+        if (workspace.settle_next(g, [](Graph::NodeId) {}, potential) == target) {
+            return workspace.distance(target);
+        }
+    }
+    return Graph::infinite_weight;
+}
+
+#endif // GOAL_DIRECTED_SEARCH_H
@@ -0,0 +1,157 @@
+// node_heap.h (Heap of Vertices Keyed by Distance)
+#ifndef NODE_HEAP_H
+#define NODE_HEAP_H
+
+#include "graph.h"
+#include "heap.h"
+
+struct HeapItem
+{
+    HeapItem(Graph::NodeId nodeid, double key): _nodeid(nodeid), _key(key) {}
+    Graph::NodeId _nodeid;
+    double _key;
+};
+
+inline bool operator<(const HeapItem & a, const HeapItem & b)
+{
+    return (a._key < b._key);
+}
+
+
+// index policy of NodeHeap: the position of every vertex in the heap, or its
+// state if it is not in the heap
+struct NodeHeapIndex
+{
+    explicit NodeHeapIndex(int num_nodes): heap_node(num_nodes, unseen) {}
+
+    void set_index(const HeapItem & item, int index)
+    {
+        heap_node[item._nodeid] = index;
+    }
+
+    static constexpr int unseen = -1;     // never inserted (or removed)
+    static constexpr int settled = -2;    // extracted
+    std::vector<int> heap_node;
+};
+
+
+// A NodeHeap either starts with all vertices at key infinite_weight, or empty
+// (lazy): then a vertex is inserted when it is first reached, and a search
+// from one vertex costs time proportional to the region it explores. Every
+// vertex is unseen, in the heap, or settled (extracted).
+template <int Arity = 2>
+class NodeHeap : public Heap<HeapItem, Arity, NodeHeapIndex> {
+    using Base = Heap<HeapItem, Arity, NodeHeapIndex>;
+public:
+    enum class State { unseen, in_heap, settled };
+
+    NodeHeap(int num_nodes, bool with_all_nodes = true): Base(NodeHeapIndex(num_nodes))
+    {   // creates a heap with all nodes having key = infinite weight, or an empty one
+        for(auto i = 0; with_all_nodes and i < num_nodes; ++i) {
+            insert(i, Graph::infinite_weight);
+        }
+    }
+
+    State state(Graph::NodeId nodeid) const
+    {
+        ensure_is_valid_nodeid(nodeid);
+        switch (heap_node(nodeid)) {
+            case NodeHeapIndex::unseen: return State::unseen;
+            case NodeHeapIndex::settled: return State::settled;
+            default: return State::in_heap;
+        }
+    }
+
+    bool is_member(Graph::NodeId nodeid) const
+    {
+        return state(nodeid) == State::in_heap;
+    }
+
+    bool is_settled(Graph::NodeId nodeid) const
+    {
+        return state(nodeid) == State::settled;
+    }
+
+    double get_key(Graph::NodeId nodeid)
+    {
+        return this->get_object(heap_node(nodeid))._key;
+    }
+
+    Graph::NodeId extract_min()
+    {
+        Graph::NodeId result = Base::extract_min()._nodeid;
+        this->policy().heap_node[result] = NodeHeapIndex::settled;
+        return result;
+    }
+
+    void insert(Graph::NodeId nodeid, double key)
+    {
+          ensure_is_valid_nodeid(nodeid);
+          if (heap_node(nodeid) == NodeHeapIndex::unseen) {
+              _seen.push_back(nodeid);
+          }
+          Base::insert(HeapItem(nodeid, key));
+    }
+
+    void decrease_key(Graph::NodeId nodeid, double new_key)
+    {
+        ensure_is_valid_nodeid(nodeid);
+        this->get_object(heap_node(nodeid))._key = new_key;
+        Base::decrease_key(heap_node(nodeid));
+    }
+
+    // Inserts an unseen vertex, or decreases the key of a vertex in the heap
+    // if key is smaller. Returns whether the key of nodeid is now key;
+    // settled vertices are left alone.
+    bool insert_or_decrease_key(Graph::NodeId nodeid, double key)
+    {
+        switch (state(nodeid)) {
+            case State::unseen:
+                insert(nodeid, key);
+                return true;
+            case State::in_heap:
+                if (key < get_key(nodeid)) {
+                    decrease_key(nodeid, key);
+                    return true;
+                }
+                return false;
+            default:
+                return false;
+        }
+    }
+
+    void remove(Graph::NodeId nodeid)
+    {
+        ensure_is_valid_nodeid(nodeid);
+        Base::remove(heap_node(nodeid));
+        this->policy().heap_node[nodeid] = NodeHeapIndex::unseen;
+    }
+
+    // empties the heap and makes all vertices unseen again, in time
+    // proportional to the number of vertices inserted since the last clear
+    void clear()
+    {
+        Base::clear();
+        for (Graph::NodeId nodeid: _seen) {
+            this->policy().heap_node[nodeid] = NodeHeapIndex::unseen;
+        }
+        _seen.clear();
+    }
+
+private:
+
+    void ensure_is_valid_nodeid(Graph::NodeId nodeid) const
+    {
+        if (nodeid < 0 or nodeid >= static_cast<int>(this->policy().heap_node.size()))
+            throw std::runtime_error("invalid nodeid in NodeHeap");
+    }
+
+    int heap_node(Graph::NodeId nodeid) const
+    {
+        return this->policy().heap_node[nodeid];
+    }
+
+    std::vector<Graph::NodeId> _seen;     // inserted since the last clear
+};
+
+#endif // NODE_HEAP_H
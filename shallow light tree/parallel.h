@@ -0,0 +1,80 @@
+// parallel.h (Running Tasks on Several Threads)
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+inline int default_num_threads()
+{
+    int num = std::thread::hardware_concurrency();
+    return num > 0 ? num : 1;
+}
+
+// Runs task(0),...,task(num_tasks-1), each on its own thread, and waits for
+// all of them. If tasks throw, the exception of the first one is rethrown.
+template <typename Task>
+void parallel_for(int num_tasks, Task task)
+{
+    if (num_tasks == 1) {
+        task(0);
+        return;
+    }
+    std::vector<std::exception_ptr> errors(num_tasks);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_tasks; ++i) {
+        threads.emplace_back([&task, &errors, i]() {
+            try {
+                task(i);
+            }
+            catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for (auto & thread: threads) {
+        thread.join();
+    }
+    for (auto & error: errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+// Lets num_threads threads wait for each other: wait() returns once all of
+// them have called it, and everything written before the call is visible
+// afterwards. Waiting threads spin and yield, since the phases between two
+// barriers are usually short.
+class Barrier {
+public:
+    explicit Barrier(int num_threads): _num_threads(num_threads), _waiting(0), _generation(0) {}
+
+    void wait()
+    {
+        int generation = _generation.load(std::memory_order_acquire);
+        if (_waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == _num_threads) {
+            _waiting.store(0, std::memory_order_relaxed);
+            _generation.fetch_add(1, std::memory_order_release);
+            return;
+        }
+        while (_generation.load(std::memory_order_acquire) == generation) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    const int _num_threads;
+    std::atomic<int> _waiting;
+    std::atomic<int> _generation;
+};
+
+// splits 0,...,size-1 into num_parts ranges; part i starts here
+inline int part_begin(int size, int num_parts, int part)
+{
+    return static_cast<long long>(size) * part / num_parts;
+}
+
+#endif // PARALLEL_H
@@ -1,89 +1,17 @@
 // primdijkstra.cpp (Prim's Algorithm and Dijkstra's Algorithm)
 
 #include "graph.h"
-#include "heap.h"
-
-struct HeapItem
-{
-    HeapItem(Graph::NodeId nodeid, double key): _nodeid(nodeid), _key(key) {}
-    Graph::NodeId _nodeid;
-    double _key;
-};
-
-bool operator<(const HeapItem & a, const HeapItem & b)
-{
-    return (a._key < b._key);
-}
-
-
-class NodeHeap : public Heap<HeapItem> {
-public:
-    NodeHeap(int num_nodes): _heap_node(num_nodes, not_in_heap)
-    {   // creates a heap with all nodes having key = infinite weight
-        for(auto i = 0; i < num_nodes; ++i) {
-            insert(i, Graph::infinite_weight);
-        }
-    }
-
-    bool is_member(Graph::NodeId nodeid) const
-    {
-        ensure_is_valid_nodeid(nodeid);
-        return _heap_node[nodeid] != not_in_heap;
-    }
-
-    double get_key(Graph::NodeId nodeid)
-    {
-        return get_object(_heap_node[nodeid])._key;
-    }
-
-    Graph::NodeId extract_min()
-    {
-        Graph::NodeId result = Heap<HeapItem>::extract_min()._nodeid;
-        _heap_node[result] = not_in_heap;
-        return result;
-    }
-
-    void insert(Graph::NodeId nodeid, double key)
-    {
-          ensure_is_valid_nodeid(nodeid);
-          HeapItem item(nodeid, key);
-          _heap_node[nodeid] = Heap<HeapItem>::insert(item);
-    }
-
-    void decrease_key(Graph::NodeId nodeid, double new_key)
-    {
-        ensure_is_valid_nodeid(nodeid);
-        get_object(_heap_node[nodeid])._key = new_key;
-        Heap<HeapItem>::decrease_key(_heap_node[nodeid]);
-    }
-
-    void remove(Graph::NodeId nodeid)
-    {
-        ensure_is_valid_nodeid(nodeid);
-        Heap<HeapItem>::remove(_heap_node[nodeid]);
-        _heap_node[nodeid] = not_in_heap;
-    }
-
-private:
-
-    void ensure_is_valid_nodeid(Graph::NodeId nodeid) const
-    {
-        if (nodeid < 0 or nodeid >= static_cast<int>(_heap_node.size()))
-            throw std::runtime_error("invalid nodeid in NodeHeap");
-    }
-
-    void swap(HeapItem & a, HeapItem & b)
-    {
-        std::swap(a,b);
-        std::swap(_heap_node[a._nodeid],_heap_node[b._nodeid]);
-    }
-
-    static const int not_in_heap;
-    std::vector<int> _heap_node;
-};
-
-int const NodeHeap::not_in_heap = -1;
-
+#include "csr_graph.h"
+#include "node_heap.h"
+#include "dijkstra_workspace.h"
+#include "bidirectional_dijkstra.h"
+#include "goal_directed_search.h"
+#include "delta_stepping.h"
+#include "contraction_hierarchy.h"
+#include "batched_shortest_paths.h"
+#include <chrono>
+#include <memory>
+#include <string>
 
 struct PrevData {
     Graph::NodeId id;
@@ -91,14 +19,15 @@ struct PrevData {
 };
 
 
-Graph mst(const Graph & g)
+template <int Arity = 2, typename G>     // G is Graph or CsrGraph; Arity of the heap, e.g. 4
+Graph mst(const G & g)
 {   // Prim's Algorithm. Assumes that g is undirected and connected.
     Graph tree(g.num_nodes(), Graph::undirected);
-    NodeHeap heap(g.num_nodes());
+    NodeHeap<Arity> heap(g.num_nodes(), false);  // vertices enter when reached
     std::vector<PrevData> prev(g.num_nodes(), {Graph::invalid_node, 0.0});
 
     const Graph::NodeId start_nodeid = 0;         // start at vertex 0
-    heap.decrease_key(start_nodeid, 0);
+    heap.insert(start_nodeid, 0);
 
     while (not heap.is_empty()) {
         Graph::NodeId nodeid = heap.extract_min();
@@ -106,11 +35,8 @@ Graph mst(const Graph & g)
             tree.add_edge(prev[nodeid].id, nodeid, prev[nodeid].weight);
         }
         for (auto neighbor: g.get_node(nodeid).adjacent_nodes()) {
-            if (heap.is_member(neighbor.id()) and
-                neighbor.edge_weight() < heap.get_key(neighbor.id()))
-            {
+            if (heap.insert_or_decrease_key(neighbor.id(), neighbor.edge_weight())) {
                 prev[neighbor.id()] = {nodeid, neighbor.edge_weight()};
-                heap.decrease_key(neighbor.id(), neighbor.edge_weight());
             }
         }
     }
@@ -118,40 +44,165 @@ Graph mst(const Graph & g)
 }
 
 
-Graph shortest_paths_tree(const Graph & g, Graph::NodeId start_nodeid)
-{   // Dijkstra's Algorithm. The graph g can be directed or undirected.
+template <int Arity = 2, typename G>     // G is Graph or CsrGraph; Arity of the heap, e.g. 4
+Graph shortest_paths_tree(const G & g, Graph::NodeId start_nodeid)
+{   // Dijkstra's Algorithm (see DijkstraWorkspace::run); uses a bucket queue if all
+    // weights are small non-negative integers. Repeated queries keep one workspace
+    // and read the tree from it instead (DijkstraWorkspace::parent).
     Graph tree(g.num_nodes(), g.dirtype);
-    NodeHeap heap(g.num_nodes());
-    std::vector<PrevData> prev(g.num_nodes(), {Graph::invalid_node, 0.0});
-
-    heap.decrease_key(start_nodeid, 0);
+    with_dijkstra_workspace<Arity>(g, [&](auto & workspace) {
+        workspace.run(g, start_nodeid);
+        workspace.tree(tree);
+    });
+    return tree;
+}
 
-    while (not heap.is_empty()) {
-        double key = heap.find_min()._key;
-        if (key == Graph::infinite_weight) {
-            break;                    // break exits the while loop immediately
-        }
-        Graph::NodeId nodeid = heap.extract_min();
-        if (nodeid != start_nodeid) {
-            tree.add_edge(prev[nodeid].id, nodeid, prev[nodeid].weight);
+
+void print_point_to_point(char const * filename, Graph::NodeId s, Graph::NodeId t,
+                          char const * data_x, char const * data_y)
+{   // the s-t distance and the number of settled vertices of each search;
+    // A* with Euclidean bounds needs the coordinate files
+    Graph h = data_x ? Graph(filename, Graph::directed, data_x, data_y)
+                     : Graph(filename, Graph::directed);
+    CsrGraph g(h);
+    CsrGraph reverse = g.reverse();
+    Graph::NodeId n = g.num_nodes();
+    if (s < 0 or s >= n or t < 0 or t >= n) {
+        throw std::runtime_error("Invalid source or target.");
+    }
+    auto report = [](char const * name, double distance, int num_settled) {
+        std::cout << name << ": distance " << distance << ", "
+                  << num_settled << " vertices settled\n";
+    };
+    DijkstraWorkspace<NodeHeap<4>> workspace(n, NodeHeap<4>(n, false));
+    workspace.run(g, s);
+    report("Dijkstra, whole tree", workspace.distance(t), workspace.settled().size());
+    workspace.run(g, s, t);
+    report("Dijkstra, up to t", workspace.distance(t), workspace.settled().size());
+
+    BidirectionalDijkstra<NodeHeap<4>> bidirectional(n, NodeHeap<4>(n, false), NodeHeap<4>(n, false));
+    double distance = bidirectional.run(g, reverse, s, t);
+    report("Bidirectional Dijkstra", distance, bidirectional.num_settled());
+
+    if (data_x) {
+        EuclideanPotential euclidean(h);
+        distance = astar_search(g, s, t, euclidean, workspace);
+        report("A*, Euclidean bounds", distance, workspace.settled().size());
+    }
+    LandmarkPotential landmarks(g, reverse, 8);
+    distance = astar_search(g, s, t, landmarks, workspace);
+    report("A*, 8 landmarks (ALT)", distance, workspace.settled().size());
+}
+
+
+void print_sssp_benchmark(char const * filename, Graph::NodeId source)
+{   // seconds for a whole shortest paths tree: Dijkstra, then delta-stepping
+    // with the automatic bucket width on 1, 2, 4, 8 and 16 threads
+    CsrGraph g(filename, Graph::directed);
+    Graph::NodeId n = g.num_nodes();
+    if (source < 0 or source >= n) {
+        throw std::runtime_error("Invalid source.");
+    }
+    auto seconds = [](auto task) {
+        auto start = std::chrono::steady_clock::now();
+        task();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    DijkstraWorkspace<NodeHeap<4>> workspace(n, NodeHeap<4>(n, false));
+    std::cout << "Dijkstra: " << seconds([&]() { workspace.run(g, source); }) << " s\n";
+
+    double delta = delta_stepping_width(g);
+    DeltaStepping delta_stepping(n);
+    for (int num_threads: {1, 2, 4, 8, 16}) {
+        double time = seconds([&]() { delta_stepping.run(g, source, delta, num_threads); });
+        bool same = true;
+        for (Graph::NodeId v = 0; v < n; ++v) {
+            same = same and delta_stepping.distance(v) == workspace.distance(v);
         }
-        for (auto neighbor: g.get_node(nodeid).adjacent_nodes()) {
-            if (heap.is_member(neighbor.id()) and
-                (key + neighbor.edge_weight() < heap.get_key(neighbor.id())))
-            {
-                prev[neighbor.id()] = {nodeid, neighbor.edge_weight()};
-                heap.decrease_key(neighbor.id(), key + neighbor.edge_weight());
-            }
+        std::cout << "Delta-stepping, delta " << delta << ", " << num_threads << " threads: "
+                  << time << " s" << (same ? "" : " (different distances)") << "\n";
+    }
+}
+
+
+void save_contraction_hierarchy(char const * filename, char const * hierarchy_file)
+{   // preprocessing once per graph; the file is read by print_batched_benchmark
+    CsrGraph g(filename, Graph::directed);
+    auto start = std::chrono::steady_clock::now();
+    ContractionHierarchy hierarchy(g);
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    hierarchy.save(hierarchy_file);
+    std::cout << "Contraction hierarchy: " << time << " s, " << hierarchy.upward().num_edges()
+              << " upward and " << hierarchy.downward().num_edges() << " downward arcs\n";
+}
+
+
+void print_batched_benchmark(char const * filename, char const * hierarchy_file, int num_sources)
+{   // seconds for the distances from num_sources sources spread over the
+    // vertices: a Dijkstra run per source, then BatchedShortestPaths on the
+    // hierarchy saved by save_contraction_hierarchy (reading it is timed apart)
+    CsrGraph g(filename, Graph::directed);
+    Graph::NodeId n = g.num_nodes();
+    if (num_sources < 1 or n < 1) {
+        throw std::runtime_error("Invalid number of sources.");
+    }
+    std::vector<Graph::NodeId> sources(num_sources);
+    for (int i = 0; i < num_sources; ++i) {
+        sources[i] = static_cast<long long>(i) * n / num_sources;
+    }
+    auto seconds = [](auto task) {
+        auto start = std::chrono::steady_clock::now();
+        task();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    std::vector<double> expected(sources.size() * static_cast<size_t>(n));
+    DijkstraWorkspace<NodeHeap<4>> workspace(n, NodeHeap<4>(n, false));
+    double dijkstra_time = seconds([&]() {
+        for (size_t i = 0; i < sources.size(); ++i) {
+            workspace.run(g, sources[i]);
+            for (Graph::NodeId v = 0; v < n; ++v) {
+                expected[i * n + v] = workspace.distance(v);
+            }
         }
+    });
+    std::cout << num_sources << " Dijkstra runs: " << dijkstra_time << " s\n";
+
+    std::unique_ptr<ContractionHierarchy> hierarchy;
+    double load_time = seconds([&]() {
+        hierarchy = std::make_unique<ContractionHierarchy>(hierarchy_file);
+    });
+    if (hierarchy->num_nodes() != n) {
+        throw std::runtime_error("The hierarchy belongs to another graph.");
     }
-    return tree;
+    std::vector<double> distances;
+    double batched_time = seconds([&]() {
+        BatchedShortestPaths batched(*hierarchy);
+        distances = batched.distances(sources);
+    });
+    std::cout << "Reading the hierarchy: " << load_time << " s\n"
+              << "Batched on the hierarchy: " << batched_time << " s"
+              << (distances == expected ? "" : " (different distances)") << "\n";
 }
-
-
+
+
 int main(int argc, char * argv[])
 {
-    if (argc > 1) {
-        Graph g(argv[1], Graph::undirected);
+    if (argc == 4 and std::string(argv[2]) == "--contract") {    // graph file, --contract, hierarchy file
+        save_contraction_hierarchy(argv[1], argv[3]);
+    }
+    else if (argc == 5 and std::string(argv[2]) == "--batched") {  // graph file, --batched, hierarchy file, number of sources
+        print_batched_benchmark(argv[1], argv[3], std::stoi(argv[4]));
+    }
+    else if (argc == 3) {                 // graph file, source
+        print_sssp_benchmark(argv[1], std::stoi(argv[2]));
+    }
+    else if (argc == 4 or argc == 6) {    // graph file, s, t [, data_x, data_y]
+        print_point_to_point(argv[1], std::stoi(argv[2]), std::stoi(argv[3]),
+                             argc == 6 ? argv[4] : nullptr, argc == 6 ? argv[5] : nullptr);
+    }
+    else if (argc > 1) {
+        // read only, so a binary graph file is used in place
+        CsrGraph g(argv[1], Graph::undirected);
         std::cout << "The following is the undirected input graph:\n";
         g.print();
 
@@ -159,7 +210,7 @@ int main(int argc, char * argv[])
         Graph t = mst(g);
         t.print();
 
-        Graph h(argv[1], Graph::directed);
+        CsrGraph h(argv[1], Graph::directed);
         std::cout << "\nThe following is the directed input graph:\n";
         h.print();
 
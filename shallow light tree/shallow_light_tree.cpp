@@ -1,87 +1,7 @@
 #include "graph.h"
-#include "heap.h"
-
-struct HeapItem
-{
-    HeapItem(Graph::NodeId nodeid, double key): _nodeid(nodeid), _key(key) {}
-    Graph::NodeId _nodeid;
-    double _key;
-};
-
-bool operator<(const HeapItem & a, const HeapItem & b)
-{
-    return (a._key < b._key);
-}
-
-
-class NodeHeap : public Heap<HeapItem> {
-public:
-    NodeHeap(int num_nodes): _heap_node(num_nodes, not_in_heap)
-    {   // creates a heap with all nodes having key = infinite weight
-        for(auto i = 0; i < num_nodes; ++i) {
-            insert(i, Graph::infinite_weight);
-        }
-    }
-
-    bool is_member(Graph::NodeId nodeid) const
-    {
-        ensure_is_valid_nodeid(nodeid);
-        return _heap_node[nodeid] != not_in_heap;
-    }
-
-    double get_key(Graph::NodeId nodeid)
-    {
-        return get_object(_heap_node[nodeid])._key;
-    }
-
-    Graph::NodeId extract_min()
-    {
-        Graph::NodeId result = Heap<HeapItem>::extract_min()._nodeid;
-        _heap_node[result] = not_in_heap;
-        return result;
-    }
-
-    void insert(Graph::NodeId nodeid, double key)
-    {
-          ensure_is_valid_nodeid(nodeid);
-          HeapItem item(nodeid, key);
-          _heap_node[nodeid] = Heap<HeapItem>::insert(item);
-    }
-
-    void decrease_key(Graph::NodeId nodeid, double new_key)
-    {
-        ensure_is_valid_nodeid(nodeid);
-        get_object(_heap_node[nodeid])._key = new_key;
-        Heap<HeapItem>::decrease_key(_heap_node[nodeid]);
-    }
-
-    void remove(Graph::NodeId nodeid)
-    {
-        ensure_is_valid_nodeid(nodeid);
-        Heap<HeapItem>::remove(_heap_node[nodeid]);
-        _heap_node[nodeid] = not_in_heap;
-    }
-
-private:
-
-    void ensure_is_valid_nodeid(Graph::NodeId nodeid) const
-    {
-        if (nodeid < 0 or nodeid >= static_cast<int>(_heap_node.size()))
-            throw std::runtime_error("invalid nodeid in NodeHeap");
-    }
-
-    void swap(HeapItem & a, HeapItem & b)
-    {
-        std::swap(a,b);
-        std::swap(_heap_node[a._nodeid],_heap_node[b._nodeid]);
-    }
-
-    static const int not_in_heap;
-    std::vector<int> _heap_node;
-};
-
-int const NodeHeap::not_in_heap = -1;
-
+#include "csr_graph.h"
+#include "node_heap.h"
+#include "dijkstra_workspace.h"
 
 struct PrevData {
     Graph::NodeId id;
@@ -89,14 +9,15 @@ struct PrevData {
 };
 
 
-Graph mst(const Graph & g)
+template <int Arity = 2, typename G>     // G is Graph or CsrGraph; Arity of the heap, e.g. 4
+Graph mst(const G & g)
 {   // Prim's Algorithm. Assumes that g is undirected and connected.
     Graph tree(g.num_nodes(), Graph::undirected);
-    NodeHeap heap(g.num_nodes());
+    NodeHeap<Arity> heap(g.num_nodes(), false);  // vertices enter when reached
     std::vector<PrevData> prev(g.num_nodes(), {Graph::invalid_node, 0.0});
 
     const Graph::NodeId start_nodeid = 0;         // start at vertex 0
-    heap.decrease_key(start_nodeid, 0);
+    heap.insert(start_nodeid, 0);
 
     while (not heap.is_empty()) {
         Graph::NodeId nodeid = heap.extract_min();
@@ -104,51 +25,28 @@ Graph mst(const Graph & g)
             tree.add_edge(prev[nodeid].id, nodeid, prev[nodeid].weight);
         }
         for (auto neighbor: g.get_node(nodeid).adjacent_nodes()) {
-            if (heap.is_member(neighbor.id()) and
-                neighbor.edge_weight() < heap.get_key(neighbor.id()))
-            {
+            if (heap.insert_or_decrease_key(neighbor.id(), neighbor.edge_weight())) {
                 prev[neighbor.id()] = {nodeid, neighbor.edge_weight()};
-                heap.decrease_key(neighbor.id(), neighbor.edge_weight());
             }
         }
     }
     return tree;
 }
 
-Graph shortest_paths_tree(const Graph & g, Graph::NodeId start_nodeid, 
-  std::vector<PrevData> &prev, std::vector<double> &paths)
-{   // Dijkstra's Algorithm. The graph g can be directed or undirected.
-
-    Graph tree(g.num_nodes(), g.dirtype);
-    NodeHeap heap(g.num_nodes());
-    //std::vector<PrevData> prev(g.num_nodes(), {Graph::invalid_node, 0.0});
-
-    heap.decrease_key(start_nodeid, 0);
-
-    while (not heap.is_empty()) {
-        double key = heap.find_min()._key;
-        if (key == Graph::infinite_weight) {
-            break;                    // break exits the while loop immediately
-        }
-        Graph::NodeId nodeid = heap.extract_min();
-        if (nodeid != start_nodeid) {
-            tree.add_edge(prev[nodeid].id, nodeid, prev[nodeid].weight);
-            paths[nodeid] = key;
-        }
-        for (auto neighbor: g.get_node(nodeid).adjacent_nodes()) {
-            if (heap.is_member(neighbor.id()) and
-                (key + neighbor.edge_weight() < heap.get_key(neighbor.id())))
-            {
-                paths[neighbor.id()] = key + neighbor.edge_weight();
-                prev[neighbor.id()] = {nodeid, neighbor.edge_weight()};
-                heap.decrease_key(neighbor.id(), key + neighbor.edge_weight());
-            }
-        }
+template <typename Queue, typename G>   // Queue is NodeHeap, DialQueue or RadixHeap
+void shortest_paths(const G & g, Graph::NodeId start_nodeid, 
+  std::vector<PrevData> &prev, std::vector<double> &paths, DijkstraWorkspace<Queue> &workspace)
+{   // Dijkstra's Algorithm (siehe DijkstraWorkspace::run). prev und paths werden nur für die
+    // erreichten Knoten geschrieben; der Baum selbst bleibt in workspace.
+    workspace.run(g, start_nodeid);
+    for (Graph::NodeId v : workspace.reached())
+    {
+        prev[v] = {workspace.parent(v), workspace.parent_weight(v)};
+        paths[v] = workspace.distance(v);
     }
-    return tree;
 }
 
-std::vector<Graph::NodeId> finde_kantenzug(Graph &g, Graph::NodeId start, 
+std::vector<Graph::NodeId> finde_kantenzug(Graph::NodeId start, 
   Graph::NodeId target, std::vector<PrevData> &prev)
 {
 
@@ -173,7 +71,9 @@ bool contains_edge(Graph &g, Graph::NodeId head, Graph::NodeId tail){
   return contains;
 }
 
-Graph shallow_light_tree(Graph & g, Graph::NodeId start_nodeid, double eps)
+template <typename Queue> //beide Dijkstra-Läufe benutzen workspace; der MST hat nur Gewichte aus g
+Graph shallow_light_tree(const CsrGraph & g, Graph::NodeId start_nodeid, double eps, 
+  DijkstraWorkspace<Queue> &workspace)
 {
 
   std::vector<double> paths(g.num_nodes(),0); //speichert die l Werte für jeden Knoten in G
@@ -182,8 +82,12 @@ Graph shallow_light_tree(Graph & g, Graph::NodeId start_nodeid, double eps)
   std::vector<PrevData> prev_graph(g.num_nodes(), {Graph::invalid_node, 0.0}); //Wurde definiert, um die Wege außerhalb der Dijksta-Funktion zu bestimmen.
   std::vector<PrevData> prev_mst(g.num_nodes(), {Graph::invalid_node, 0.0}); //"
 
-  Graph graph_shortest_path_tree = shortest_paths_tree(g,start_nodeid, prev_graph,paths); 
-  Graph mst_shortest_path_tree = shortest_paths_tree(mst(g),start_nodeid, prev_mst, paths_mst);
+  //vom kürzeste Wege Baum in G reichen prev_graph und paths, nur der in S wird verändert
+  shortest_paths(g,start_nodeid, prev_graph,paths,workspace); 
+  Graph mst_graph = mst(g);
+  shortest_paths(mst_graph,start_nodeid, prev_mst, paths_mst,workspace);
+  Graph mst_shortest_path_tree(mst_graph.num_nodes(), mst_graph.dirtype);
+  workspace.tree(mst_shortest_path_tree);
 
   std::vector<bool> changed_mst(g.num_nodes(), false); //Bezeichnet, ob für einen Knoten der l-Wert durch kürzeste Wege Baum ersetzt wurde.
   std::vector<bool> changed_graph(g.num_nodes(), false); // "
@@ -191,10 +95,10 @@ Graph shallow_light_tree(Graph & g, Graph::NodeId start_nodeid, double eps)
   {
     if ((1+eps)*paths[i]<paths_mst[i] && changed_mst[i] == false) //Überprüfe, ob l-Wert in MST viel größer als l-Wert im kürzesten Wege Baum.
     {
-      std::vector<Graph::NodeId> v = finde_kantenzug(mst_shortest_path_tree, 
-        start_nodeid, i, prev_mst); //Finde den Weg [s,i] in MST.
-      std::vector<Graph::NodeId> w = finde_kantenzug(graph_shortest_path_tree, 
-        start_nodeid, i, prev_graph); //Finde den Weg [s,i] im kürzesten Wege Baum.
+      std::vector<Graph::NodeId> v = finde_kantenzug(start_nodeid, 
+        i, prev_mst); //Finde den Weg [s,i] in MST.
+      std::vector<Graph::NodeId> w = finde_kantenzug(start_nodeid, 
+        i, prev_graph); //Finde den Weg [s,i] im kürzesten Wege Baum.
       for (int j = 1; j < v.size(); ++j)
       {
         if /*((changed_mst[v[j]] == false && changed_mst[v[j-1]] == false) || 
@@ -212,7 +116,7 @@ Graph shallow_light_tree(Graph & g, Graph::NodeId start_nodeid, double eps)
           !contains_edge(mst_shortest_path_tree, w[k], w[k-1]))
         {
           mst_shortest_path_tree.add_edge(w[k], w[k-1], 
-            graph_shortest_path_tree.get_edge(w[k], w[k-1]).weight());
+            prev_graph[w[k-1]].weight); //w[k] ist der Vorgänger von w[k-1]
         }
       }
       for (int l = 0; l < v.size(); ++l)
@@ -225,11 +129,18 @@ Graph shallow_light_tree(Graph & g, Graph::NodeId start_nodeid, double eps)
 return mst_shortest_path_tree;
 }
 
+Graph shallow_light_tree(const CsrGraph & g, Graph::NodeId start_nodeid, double eps)
+{
+  return with_dijkstra_workspace(g, [&](auto & workspace) {
+    return shallow_light_tree(g, start_nodeid, eps, workspace);
+  });
+}
+
 int main(int argc, char* argv[])
 {	
 	if (argc > 1) 
   {
-      Graph g(argv[1], Graph::undirected);
+      CsrGraph g(argv[1], Graph::undirected); //wird nur gelesen; Binärdateien werden nicht kopiert
       double eps;
       Graph::NodeId start;
       std::vector<PrevData> prev(g.num_nodes(), {Graph::invalid_node, 0.0}); 